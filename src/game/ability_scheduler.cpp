@@ -0,0 +1,83 @@
+#include "ability_scheduler.h"
+
+enum
+{
+  STALE_ENTRY_FACTOR = 4
+};
+
+AbilityScheduler::AbilityScheduler(int fish_capacity) :
+  generations(static_cast<size_t>(fish_capacity), 0)
+{
+  heap.reserve(generations.size() * STALE_ENTRY_FACTOR);
+}
+
+/**
+ *   @brief   Registers the next ability time of a fish
+ *   @details Replaces whatever was scheduled for the fish before.
+ *   @param   fish The fish id.
+ *   @param   fire_time The absolute game time, in seconds, it fires at.
+ */
+
+void AbilityScheduler::schedule(int fish, double fire_time)
+{
+  cancel(fish);
+  if (heap.size() >= heap.capacity())
+  {
+    compact();
+  }
+  heap.push_back({ fire_time, fish, generations[static_cast<size_t>(fish)] });
+  std::push_heap(heap.begin(), heap.end(), later);
+}
+
+/**
+ *   @brief   Stretches the time left until every pending ability
+ *   @details For a change of the charge rate: what is left of each
+ *            charge is kept and finishes at the new rate. The mapping
+ *            keeps the order of the entries, so the heap stays valid.
+ *   @param   now The current game time, in seconds.
+ *   @param   factor The old rate over the new one.
+ */
+
+void AbilityScheduler::rescale(double now, double factor)
+{
+  for (auto& entry : heap)
+  {
+    if (entry.time > now)
+    {
+      entry.time = now + (entry.time - now) * factor;
+    }
+  }
+}
+
+void AbilityScheduler::cancel(int fish)
+{
+  generations[static_cast<size_t>(fish)]++;
+}
+
+void AbilityScheduler::clear()
+{
+  heap.clear();
+  for (auto& generation : generations)
+  {
+    generation++;
+  }
+}
+
+/**
+ *   @brief   Drops stale entries from the heap
+ *   @details Only runs when the heap fills its reserved space, which
+ *            keeps it from growing when fish are replaced quickly.
+ */
+
+void AbilityScheduler::compact()
+{
+  heap.erase(std::remove_if(heap.begin(),
+                            heap.end(),
+                            [this](const Entry& entry) {
+                              return entry.generation !=
+                                     generations[static_cast<size_t>(
+                                       entry.fish)];
+                            }),
+             heap.end());
+  std::make_heap(heap.begin(), heap.end(), later);
+}
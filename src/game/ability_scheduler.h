@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+/**
+ *  Keeps the next special ability time of every fish in a min-heap,
+ *  so each tick only the fish that are due get looked at.
+ *  Rescheduling or cancelling a fish leaves its old entry in the heap,
+ *  it is recognised as stale by its generation and dropped when popped.
+ */
+class AbilityScheduler
+{
+ public:
+  explicit AbilityScheduler(int fish_capacity);
+
+  void schedule(int fish, double fire_time);
+  void rescale(double now, double factor);
+  void cancel(int fish);
+  void clear();
+  int pending() const { return static_cast<int>(heap.size()); }
+  size_t bytes() const
+  {
+    return heap.capacity() * sizeof(Entry) +
+           generations.capacity() * sizeof(unsigned);
+  }
+
+  /**
+   *  Pops every entry due at or before now and calls fire(fish) for
+   *  the live ones. fire may schedule the fish again.
+   */
+  template<typename Fire>
+  void runDue(double now, Fire&& fire)
+  {
+    while (!heap.empty() && heap.front().time <= now)
+    {
+      std::pop_heap(heap.begin(), heap.end(), later);
+      Entry due = heap.back();
+      heap.pop_back();
+      if (due.generation == generations[static_cast<size_t>(due.fish)])
+      {
+        fire(due.fish);
+      }
+    }
+  }
+
+ private:
+  struct Entry
+  {
+    double time;
+    int fish;
+    unsigned generation;
+  };
+
+  static bool later(const Entry& lhs, const Entry& rhs)
+  {
+    return lhs.time > rhs.time;
+  }
+
+  void compact();
+
+  std::vector<Entry> heap;
+  std::vector<unsigned> generations; /**< Live generation per fish. */
+};
@@ -0,0 +1,359 @@
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#  include <malloc.h>
+#endif
+
+#include "alloc_tracker.h"
+
+namespace
+{
+  // plain thread locals, so counting never allocates itself
+  thread_local AllocTracker::Phase current_phase = AllocTracker::OTHER;
+  thread_local long phase_allocations[AllocTracker::PHASE_COUNT] = { 0 };
+  thread_local long phase_bytes[AllocTracker::PHASE_COUNT] = { 0 };
+}
+
+#ifdef NEMO_TRACK_ALLOCATIONS
+
+void* operator new(std::size_t size)
+{
+  AllocTracker::count(size);
+  void* memory = std::malloc(size > 0 ? size : 1);
+  if (memory == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  AllocTracker::count(size);
+  return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+  return operator new(size, tag);
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+  std::free(memory);
+}
+
+#  ifdef __cpp_aligned_new
+
+namespace
+{
+  void* allocateAligned(std::size_t size, std::align_val_t alignment)
+  {
+    auto align = static_cast<std::size_t>(alignment);
+#    ifdef _WIN32
+    return _aligned_malloc(size > 0 ? size : 1, align);
+#    else
+    void* memory = nullptr;
+    align = align < sizeof(void*) ? sizeof(void*) : align;
+    return posix_memalign(&memory, align, size > 0 ? size : 1) == 0
+             ? memory
+             : nullptr;
+#    endif
+  }
+
+  void freeAligned(void* memory)
+  {
+#    ifdef _WIN32
+    _aligned_free(memory);
+#    else
+    std::free(memory);
+#    endif
+  }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  AllocTracker::count(size);
+  void* memory = allocateAligned(size, alignment);
+  if (memory == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size,
+                   std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept
+{
+  AllocTracker::count(size);
+  return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size,
+                     std::align_val_t alignment,
+                     const std::nothrow_t& tag) noexcept
+{
+  return operator new(size, alignment, tag);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+  freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+  freeAligned(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+  freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept
+{
+  freeAligned(memory);
+}
+
+void operator delete(void* memory,
+                     std::align_val_t,
+                     const std::nothrow_t&) noexcept
+{
+  freeAligned(memory);
+}
+
+void operator delete[](void* memory,
+                       std::align_val_t,
+                       const std::nothrow_t&) noexcept
+{
+  freeAligned(memory);
+}
+
+#  endif
+
+bool AllocTracker::instrumented()
+{
+  return true;
+}
+
+#else
+
+bool AllocTracker::instrumented()
+{
+  return false;
+}
+
+#endif
+
+AllocTracker::Scope::Scope(Phase phase) : previous(current_phase)
+{
+  current_phase = phase;
+}
+
+AllocTracker::Scope::~Scope()
+{
+  current_phase = previous;
+}
+
+void AllocTracker::count(size_t bytes)
+{
+  phase_allocations[current_phase]++;
+  phase_bytes[current_phase] += static_cast<long>(bytes);
+}
+
+/**
+ *   @brief   Drops the calling thread's counts since the last frame
+ *   @details Used once loading is done, so start-up allocations are
+ *            not charged to the first frame.
+ */
+
+void AllocTracker::discard()
+{
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    phase_allocations[phase] = 0;
+    phase_bytes[phase] = 0;
+  }
+}
+
+/**
+ *   @brief   Moves the calling thread's counts into a hand-off slot
+ *   @details For work done on another thread on behalf of the frame.
+ *            The slot must be passed to collect on the game thread
+ *            after a synchronising wait.
+ *   @param   counts PHASE_COUNT counts, added to.
+ */
+
+void AllocTracker::handOff(Counts* counts)
+{
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    counts[phase].allocations += phase_allocations[phase];
+    counts[phase].bytes += phase_bytes[phase];
+    phase_allocations[phase] = 0;
+    phase_bytes[phase] = 0;
+  }
+}
+
+/**
+ *   @brief   Adds handed off counts to the calling thread's frame
+ *   @param   counts PHASE_COUNT counts, emptied.
+ */
+
+void AllocTracker::collect(Counts* counts)
+{
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    phase_allocations[phase] += counts[phase].allocations;
+    phase_bytes[phase] += counts[phase].bytes;
+    counts[phase] = Counts();
+  }
+}
+
+const char* AllocTracker::name(Phase phase)
+{
+  switch (phase)
+  {
+    case OTHER:
+      return "other";
+    case INPUT:
+      return "input";
+    case UPDATE:
+      return "update";
+    case RENDER:
+      return "render";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ *   @brief   Sets the allocation budget of a gameplay frame
+ *   @param   allocations_per_frame The most allocations allowed.
+ *   @param   warmup_frames Gameplay frames left unchecked at the start,
+ *            while pools and caches fill.
+ */
+
+void AllocTracker::budget(long allocations_per_frame, int warmup_frames)
+{
+  allowed = allocations_per_frame;
+  warmup = warmup_frames;
+}
+
+/**
+ *   @brief   Closes the calling thread's frame
+ *   @details Takes the thread's counts since the last call as the
+ *            frame, checks it against the budget when it is a
+ *            steady-state gameplay frame and rebuilds the HUD line.
+ *   @param   gameplay True when the frame ran the game rather than
+ *            the menu.
+ */
+
+void AllocTracker::endFrame(bool gameplay)
+{
+  long frame_allocations = 0;
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    last_frame[phase].allocations = phase_allocations[phase];
+    last_frame[phase].bytes = phase_bytes[phase];
+    totals[phase].allocations += phase_allocations[phase];
+    totals[phase].bytes += phase_bytes[phase];
+    frame_allocations += phase_allocations[phase];
+    phase_allocations[phase] = 0;
+    phase_bytes[phase] = 0;
+  }
+  frames++;
+
+  if (gameplay && gameplay_frames++ >= warmup)
+  {
+    checked_frames++;
+    if (frame_allocations > worst_frame)
+    {
+      worst_frame = frame_allocations;
+    }
+    if (allowed >= 0 && frame_allocations > allowed)
+    {
+      frames_over_budget++;
+    }
+  }
+
+  std::snprintf(hud_text,
+                sizeof(hud_text),
+                "Allocs: %ld/frame, input %ld, update %ld, render %ld",
+                frame_allocations,
+                last_frame[INPUT].allocations,
+                last_frame[UPDATE].allocations,
+                last_frame[RENDER].allocations);
+}
+
+void AllocTracker::dump(std::ostream& out) const
+{
+  if (!instrumented())
+  {
+    out << "  not tracked, build with TRACK_ALLOCATIONS\n";
+    return;
+  }
+  char line[160];
+  for (int phase = 0; phase < PHASE_COUNT; phase++)
+  {
+    std::snprintf(line,
+                  sizeof(line),
+                  "  %-8s %9.1f allocs/frame %11.0f bytes/frame\n",
+                  name(static_cast<Phase>(phase)),
+                  frames > 0 ? static_cast<double>(totals[phase].allocations) /
+                                 static_cast<double>(frames)
+                             : 0.0,
+                  frames > 0 ? static_cast<double>(totals[phase].bytes) /
+                                 static_cast<double>(frames)
+                             : 0.0);
+    out << line;
+  }
+  std::snprintf(line,
+                sizeof(line),
+                "  steady state: %ld frames checked, worst %ld allocs, "
+                "%ld over budget of %ld\n",
+                checked_frames,
+                worst_frame,
+                frames_over_budget,
+                allowed);
+  out << line;
+}
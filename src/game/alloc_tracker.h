@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+
+/**
+ *  Counts heap allocations per frame and per phase of the frame.
+ *  Builds configured with TRACK_ALLOCATIONS replace the global
+ *  operator new and delete, and every allocation on a thread is added
+ *  to that thread's current phase. Other builds compile the same calls
+ *  but every count stays at zero. The game thread closes a frame with
+ *  endFrame(), after collecting what helper threads handed off for
+ *  it. Steady-state gameplay frames are checked against a
+ *  budget, so a headless run can fail when the frame loop allocates.
+ */
+class AllocTracker
+{
+ public:
+  enum Phase
+  {
+    OTHER = 0,  /**< Engine work between frames, such as event polling. */
+    INPUT = 1,  /**< The key and click callbacks. */
+    UPDATE = 2,
+    RENDER = 3,
+    PHASE_COUNT = 4
+  };
+
+  struct Counts
+  {
+    long allocations = 0;
+    long bytes = 0;
+  };
+
+  /**
+   *  Attributes the calling thread's allocations to a phase until the
+   *  end of the scope.
+   */
+  class Scope
+  {
+   public:
+    explicit Scope(Phase phase);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    Phase previous;
+  };
+
+  static bool instrumented();
+  static void count(size_t bytes);
+  static void discard();
+  static void handOff(Counts* counts);
+  static void collect(Counts* counts);
+
+  void budget(long allocations_per_frame, int warmup_frames);
+  void endFrame(bool gameplay);
+  bool withinBudget() const { return frames_over_budget == 0; }
+
+  const Counts& lastFrame(Phase phase) const { return last_frame[phase]; }
+  const char* hudText() const { return hud_text; }
+  void dump(std::ostream& out) const;
+
+  static const char* name(Phase phase);
+
+ private:
+  Counts last_frame[PHASE_COUNT];
+  Counts totals[PHASE_COUNT];
+  long frames = 0;
+  long gameplay_frames = 0;
+  long checked_frames = 0;
+  long frames_over_budget = 0;
+  long worst_frame = 0;
+  long allowed = -1; /**< Allocations allowed per frame, -1 for no limit. */
+  int warmup = 0;
+  char hud_text[96] = "";
+};
+
+/**
+ *  Attributes allocations to a phase for the rest of the scope.
+ */
+#define ALLOC_JOIN_LINE(prefix, line) prefix##line
+#define ALLOC_SCOPE_NAME(line) ALLOC_JOIN_LINE(alloc_scope_, line)
+#define ALLOC_PHASE(phase)                                                     \
+  AllocTracker::Scope ALLOC_SCOPE_NAME(__LINE__)(AllocTracker::phase)
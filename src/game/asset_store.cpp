@@ -0,0 +1,45 @@
+#include "asset_store.h"
+#include "logger.h"
+#include "null_renderer.h"
+
+namespace
+{
+  const char* const TEXTURE_PATHS[] = { "/data/images/background.jpg",
+                                        "/data/images/clown-fish-icon.png",
+                                        "/data/images/lifebar.png" };
+}
+
+AssetStore::AssetStore() = default;
+
+AssetStore::~AssetStore() = default;
+
+/**
+ *   @brief   Decodes everything the sessions share
+ *   @details Must run on one thread before the first session is
+ *            initialised. A fish image that cannot be decoded falls
+ *            back to box collisions, as a single game does.
+ */
+
+void AssetStore::load()
+{
+  for (const char* path : TEXTURE_PATHS)
+  {
+    textures[path] = std::make_unique<NullTexture>(path);
+  }
+  if (!fish_mask.load("/data/images/clown-fish-icon.png"))
+  {
+    LOG_WARN("assets::Clownfish mask unavailable, using boxes");
+    fish_mask.fill(1, 1);
+  }
+}
+
+/**
+ *   @brief   Finds a preloaded texture
+ *   @return  nullptr if the path is not one the store loads.
+ */
+
+const NullTexture* AssetStore::texture(const std::string& path) const
+{
+  auto found = textures.find(path);
+  return found == textures.end() ? nullptr : found->second.get();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+
+#include "hit_mask.h"
+
+class NullTexture;
+
+/**
+ *  Assets decoded once and shared by every session a process hosts.
+ *  The store is filled before any session starts and only read after
+ *  that, so sessions on different threads use it without locking.
+ */
+class AssetStore
+{
+ public:
+  AssetStore();
+  ~AssetStore();
+  AssetStore(const AssetStore&) = delete;
+  AssetStore& operator=(const AssetStore&) = delete;
+
+  void load();
+
+  const HitMask& fishMask() const { return fish_mask; }
+  const NullTexture* texture(const std::string& path) const;
+  int textureCount() const { return static_cast<int>(textures.size()); }
+
+ private:
+  HitMask fish_mask;
+  std::map<std::string, std::unique_ptr<NullTexture>> textures;
+};
@@ -0,0 +1,40 @@
+#include <cmath>
+
+#include "fish_motion.h"
+
+namespace
+{
+  /**
+   *   @brief   Evaluates one axis of the segment with wrap-around
+   *   @details Heading forward the axis runs from -margin - size up to
+   *            the extent, heading back from -size up to extent +
+   *            margin. Both cycles are extent + margin + size long.
+   */
+
+  float wrapped(float origin,
+                float velocity,
+                double elapsed,
+                float size,
+                float margin,
+                float extent)
+  {
+    double low = velocity >= 0 ? -margin - size : -size;
+    double period = static_cast<double>(extent) + margin + size;
+    double offset = std::fmod(origin + velocity * elapsed - low, period);
+    if (offset < 0)
+    {
+      offset += period;
+    }
+    return static_cast<float>(low + offset);
+  }
+}
+
+float FishMotion::x(double time, float width) const
+{
+  return wrapped(origin_x, velocity_x, time - start, size, margin, width);
+}
+
+float FishMotion::y(double time, float height) const
+{
+  return wrapped(origin_y, velocity_y, time - start, size, margin, height);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ *  A fish's straight line course since it last changed.
+ *  The position at any time is worked out from the segment directly,
+ *  so nothing is stepped per frame and no rounding error builds up.
+ *  A fish swims up to margin past the far edge of the window before it
+ *  wraps back to just outside the edge it is swimming away from.
+ */
+struct FishMotion
+{
+  float origin_x = 0;   /**< Position at the start of the segment. */
+  float origin_y = 0;
+  float velocity_x = 0; /**< In pixels per second. */
+  float velocity_y = 0;
+  float size = 0;       /**< Wraps once this far past the near edge. */
+  float margin = 0;     /**< Swims this far past the far edge. */
+  double start = 0;     /**< Game time of the segment, in seconds. */
+
+  float x(double time, float width) const;
+  float y(double time, float height) const;
+};
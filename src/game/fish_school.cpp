@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cmath>
+
+#include "fish_school.h"
+
+enum
+{
+  NEIGHBOUR_RADIUS = 48,
+  SEPARATION_RADIUS = 20,
+  MAX_NEIGHBOURS = 16
+};
+
+namespace
+{
+  const float ALIGNMENT_WEIGHT = 2.0f;
+  const float COHESION_WEIGHT = 1.0f;
+  const float SEPARATION_WEIGHT = 40.0f;
+}
+
+FishSchool::FishSchool(int capacity, float width, float height) :
+  columns(static_cast<int>(width) / NEIGHBOUR_RADIUS + 1),
+  rows(static_cast<int>(height) / NEIGHBOUR_RADIUS + 1),
+  flock(static_cast<size_t>(capacity)),
+  next_heading_x(static_cast<size_t>(capacity)),
+  next_heading_y(static_cast<size_t>(capacity)),
+  boid_cell(static_cast<size_t>(capacity)),
+  cell_start(static_cast<size_t>(columns * rows + 1)),
+  order(static_cast<size_t>(capacity)),
+  neighbour_limit(MAX_NEIGHBOURS)
+{
+}
+
+/**
+ *   @brief   Caps how many neighbours each fish steers by
+ *   @details Clamped to between one and MAX_NEIGHBOURS.
+ */
+
+void FishSchool::neighbourLimit(int limit)
+{
+  neighbour_limit =
+    std::max(1, std::min(limit, static_cast<int>(MAX_NEIGHBOURS)));
+}
+
+/**
+ *   @brief   Finds the grid cell a point falls in
+ *   @details Fish drift a little outside the window before wrapping,
+ *            those are kept in the border cells.
+ */
+
+int FishSchool::cellOf(float x, float y) const
+{
+  int column = static_cast<int>(x) / NEIGHBOUR_RADIUS;
+  int row = static_cast<int>(y) / NEIGHBOUR_RADIUS;
+  column = column < 0 ? 0 : (column >= columns ? columns - 1 : column);
+  row = row < 0 ? 0 : (row >= rows ? rows - 1 : row);
+  return row * columns + column;
+}
+
+/**
+ *   @brief   Bins the boids into the grid
+ *   @details A counting sort, so the rebuild is linear in the number
+ *            of boids and needs no allocation.
+ */
+
+void FishSchool::rebuildGrid(int count)
+{
+  std::fill(cell_start.begin(), cell_start.end(), 0);
+  for (int i = 0; i < count; i++)
+  {
+    auto id = static_cast<size_t>(i);
+    boid_cell[id] = cellOf(flock[id].x, flock[id].y);
+    cell_start[static_cast<size_t>(boid_cell[id] + 1)]++;
+  }
+  for (size_t cell = 1; cell < cell_start.size(); cell++)
+  {
+    cell_start[cell] += cell_start[cell - 1];
+  }
+  // cell_start is used as a fill cursor, then shifted back
+  for (int i = 0; i < count; i++)
+  {
+    auto cell = static_cast<size_t>(boid_cell[static_cast<size_t>(i)]);
+    order[static_cast<size_t>(cell_start[cell]++)] = i;
+  }
+  for (size_t cell = cell_start.size() - 1; cell > 0; cell--)
+  {
+    cell_start[cell] = cell_start[cell - 1];
+  }
+  cell_start[0] = 0;
+}
+
+/**
+ *   @brief   Steers every boid towards its neighbours
+ *   @details Alignment turns a boid towards the average heading,
+ *            cohesion towards the centre of its neighbours and
+ *            separation away from anything too close. The new headings
+ *            are written back into the boids once all are computed.
+ *   @param   count The number of boids in use.
+ *   @param   delta_seconds The length of the tick.
+ */
+
+void FishSchool::steer(int count, float delta_seconds)
+{
+  rebuildGrid(count);
+  neighbour_checks = 0;
+  const float radius_sq = NEIGHBOUR_RADIUS * NEIGHBOUR_RADIUS;
+  const float separation_sq = SEPARATION_RADIUS * SEPARATION_RADIUS;
+
+  for (int i = 0; i < count; i++)
+  {
+    const Boid& self = flock[static_cast<size_t>(i)];
+    int home = boid_cell[static_cast<size_t>(i)];
+    int home_column = home % columns;
+    int home_row = home / columns;
+    float align_x = 0;
+    float align_y = 0;
+    float centre_x = 0;
+    float centre_y = 0;
+    float push_x = 0;
+    float push_y = 0;
+    int neighbours = 0;
+
+    for (int row = home_row - 1; row <= home_row + 1; row++)
+    {
+      for (int column = home_column - 1; column <= home_column + 1; column++)
+      {
+        if (row < 0 || row >= rows || column < 0 || column >= columns)
+        {
+          continue;
+        }
+        auto cell = static_cast<size_t>(row * columns + column);
+        for (int slot = cell_start[cell];
+             slot < cell_start[cell + 1] && neighbours < neighbour_limit;
+             slot++)
+        {
+          int other_id = order[static_cast<size_t>(slot)];
+          if (other_id == i)
+          {
+            continue;
+          }
+          const Boid& other = flock[static_cast<size_t>(other_id)];
+          neighbour_checks++;
+          float dx = self.x - other.x;
+          float dy = self.y - other.y;
+          float distance_sq = dx * dx + dy * dy;
+          if (distance_sq > radius_sq)
+          {
+            continue;
+          }
+          neighbours++;
+          align_x += other.heading_x;
+          align_y += other.heading_y;
+          centre_x += other.x;
+          centre_y += other.y;
+          if (distance_sq < separation_sq && distance_sq > 0)
+          {
+            push_x += dx / distance_sq;
+            push_y += dy / distance_sq;
+          }
+        }
+      }
+    }
+
+    float heading_x = self.heading_x;
+    float heading_y = self.heading_y;
+    if (neighbours > 0)
+    {
+      auto inverse = 1.0f / static_cast<float>(neighbours);
+      heading_x += delta_seconds *
+                   (ALIGNMENT_WEIGHT * (align_x * inverse - self.heading_x) +
+                    COHESION_WEIGHT * (centre_x * inverse - self.x) /
+                      NEIGHBOUR_RADIUS +
+                    SEPARATION_WEIGHT * push_x);
+      heading_y += delta_seconds *
+                   (ALIGNMENT_WEIGHT * (align_y * inverse - self.heading_y) +
+                    COHESION_WEIGHT * (centre_y * inverse - self.y) /
+                      NEIGHBOUR_RADIUS +
+                    SEPARATION_WEIGHT * push_y);
+    }
+    float length = std::sqrt(heading_x * heading_x + heading_y * heading_y);
+    if (length > 0)
+    {
+      heading_x /= length;
+      heading_y /= length;
+    }
+    else
+    {
+      heading_x = self.heading_x;
+      heading_y = self.heading_y;
+    }
+    next_heading_x[static_cast<size_t>(i)] = heading_x;
+    next_heading_y[static_cast<size_t>(i)] = heading_y;
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    auto id = static_cast<size_t>(i);
+    flock[id].heading_x = next_heading_x[id];
+    flock[id].heading_y = next_heading_y[id];
+  }
+}
+
+size_t FishSchool::bytes() const
+{
+  return flock.capacity() * sizeof(Boid) +
+         (next_heading_x.capacity() + next_heading_y.capacity()) *
+           sizeof(float) +
+         (boid_cell.capacity() + cell_start.capacity() + order.capacity()) *
+           sizeof(int);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ *  Schooling (boids) steering for a population of fish.
+ *  Fish are binned into a uniform cell grid rebuilt every tick, so a
+ *  fish only looks at the cells around it and at most MAX_NEIGHBOURS
+ *  fish in them, keeping a tick at O(N*k) rather than O(N^2). A lower
+ *  neighbour limit trades schooling detail for time.
+ */
+class FishSchool
+{
+ public:
+  /**
+   *  The position and unit heading of one fish.
+   */
+  struct Boid
+  {
+    float x = 0;
+    float y = 0;
+    float heading_x = 1;
+    float heading_y = 0;
+  };
+
+  FishSchool(int capacity, float width, float height);
+
+  Boid* boids() { return flock.data(); }
+  void steer(int count, float delta_seconds);
+  void neighbourLimit(int limit);
+  long neighbourChecks() const { return neighbour_checks; }
+  size_t bytes() const;
+
+ private:
+  void rebuildGrid(int count);
+  int cellOf(float x, float y) const;
+
+  int columns = 0;
+  int rows = 0;
+  std::vector<Boid> flock;
+  std::vector<float> next_heading_x;
+  std::vector<float> next_heading_y;
+  std::vector<int> boid_cell;  /**< Cell of each boid. */
+  std::vector<int> cell_start; /**< First slot in order per cell. */
+  std::vector<int> order;      /**< Boid ids sorted by cell. */
+  long neighbour_checks = 0;
+  int neighbour_limit;
+};
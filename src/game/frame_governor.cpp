@@ -0,0 +1,128 @@
+#include <cstdio>
+
+#include "frame_governor.h"
+
+/**
+ *   @brief   Sets the time a frame's work may take
+ *   @details Zero or less turns the governor off and restores full
+ *            detail.
+ */
+
+void FrameGovernor::budget(double frame_ms)
+{
+  budget_ms = frame_ms > 0 ? frame_ms : 0;
+  if (budget_ms <= 0)
+  {
+    current_level = FULL_LEVEL;
+  }
+}
+
+/**
+ *   @brief   Adjusts the detail level after a frame
+ *   @details A single frame close to the budget is enough to drop a
+ *            level, as is a smoothed time that creeps up to it. After
+ *            a change the level is held for SETTLE_FRAMES so its effect
+ *            shows in the times before the next decision.
+ *   @param   update_ms The work in update, the pacer wait excluded.
+ *   @param   render_ms The work in render.
+ */
+
+void FrameGovernor::frame(double update_ms, double render_ms)
+{
+  double work_ms = update_ms + render_ms;
+  smoothed_ms += (work_ms - smoothed_ms) / SMOOTHING_FRAMES;
+  frames++;
+  total_ms += work_ms;
+  if (work_ms > worst_ms)
+  {
+    worst_ms = work_ms;
+  }
+
+  if (budget_ms > 0)
+  {
+    if (work_ms > budget_ms)
+    {
+      frames_over_budget++;
+    }
+    double drop_ms = budget_ms * DROP_PERCENT / 100;
+    if (settle > 0)
+    {
+      settle--;
+    }
+    else if (work_ms > drop_ms || smoothed_ms > drop_ms)
+    {
+      if (current_level > 0)
+      {
+        current_level--;
+        level_drops++;
+        settle = SETTLE_FRAMES;
+      }
+      calm_frames = 0;
+    }
+    else if (smoothed_ms < budget_ms * RAISE_PERCENT / 100)
+    {
+      if (++calm_frames >= RAISE_AFTER_FRAMES && current_level < FULL_LEVEL)
+      {
+        current_level++;
+        settle = SETTLE_FRAMES;
+        calm_frames = 0;
+      }
+    }
+    else
+    {
+      calm_frames = 0;
+    }
+  }
+
+  std::snprintf(hud_text,
+                sizeof(hud_text),
+                "Governor: level %d/%d, %.2fms of %.2fms",
+                current_level,
+                static_cast<int>(FULL_LEVEL),
+                smoothed_ms,
+                budget_ms);
+}
+
+/**
+ *   @brief   Whether the game may add fish this frame
+ */
+
+bool FrameGovernor::allowSpawn() const
+{
+  return budget_ms <= 0 || (current_level == FULL_LEVEL &&
+                            smoothed_ms < budget_ms * SPAWN_PERCENT / 100);
+}
+
+/**
+ *   @brief   The share of each particle burst to emit
+ *   @return  From a quarter at the lowest level to all of it.
+ */
+
+float FrameGovernor::particleDensity() const
+{
+  return 0.25f + 0.75f * static_cast<float>(current_level) / FULL_LEVEL;
+}
+
+int FrameGovernor::neighbourLimit() const
+{
+  return MIN_NEIGHBOURS +
+         (FULL_NEIGHBOURS - MIN_NEIGHBOURS) * current_level / FULL_LEVEL;
+}
+
+void FrameGovernor::dump(std::ostream& out) const
+{
+  char line[160];
+  std::snprintf(line,
+                sizeof(line),
+                "  budget %.2fms, %ld frames, work mean %.2fms worst "
+                "%.2fms\n  %ld over budget, %ld level drops, ended at "
+                "level %d\n",
+                budget_ms,
+                frames,
+                frames > 0 ? total_ms / static_cast<double>(frames) : 0.0,
+                worst_ms,
+                frames_over_budget,
+                level_drops,
+                current_level);
+  out << line;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <ostream>
+
+/**
+ *  Keeps the work of a frame inside a time budget by trading detail.
+ *  The game reports how long update and render worked each frame,
+ *  pacing excluded. Nearing the budget drops the detail level at once,
+ *  a long spell well under it raises the level again one step at a
+ *  time. The level sets the particle density and how many neighbours
+ *  a schooling fish looks at; new fish are only allowed while the
+ *  level is full and there is headroom left.
+ */
+class FrameGovernor
+{
+ public:
+  enum
+  {
+    LEVEL_COUNT = 8,
+    FULL_LEVEL = LEVEL_COUNT - 1,
+    SMOOTHING_FRAMES = 8,
+    SETTLE_FRAMES = 10,       /**< Frames between two level changes. */
+    RAISE_AFTER_FRAMES = 120, /**< Calm frames before a level is won back. */
+    DROP_PERCENT = 90,        /**< Of the budget, a frame past it drops. */
+    RAISE_PERCENT = 60,       /**< Of the budget, calm below it. */
+    SPAWN_PERCENT = 70,       /**< Of the budget, new fish below it. */
+    MIN_NEIGHBOURS = 4,
+    FULL_NEIGHBOURS = 16
+  };
+
+  void budget(double frame_ms);
+  double budgetMs() const { return budget_ms; }
+  void frame(double update_ms, double render_ms);
+
+  int level() const { return current_level; }
+  bool allowSpawn() const;
+  float particleDensity() const;
+  int neighbourLimit() const;
+
+  const char* hudText() const { return hud_text; }
+  void dump(std::ostream& out) const;
+
+ private:
+  double budget_ms = 0; /**< 0 leaves the detail at full. */
+  int current_level = FULL_LEVEL;
+  double smoothed_ms = 0;
+  int settle = 0;
+  int calm_frames = 0;
+  long frames = 0;
+  long frames_over_budget = 0;
+  long level_drops = 0;
+  double total_ms = 0;
+  double worst_ms = 0;
+  char hud_text[96] = "";
+};
@@ -0,0 +1,71 @@
+#include "frame_history.h"
+
+FrameHistory::FrameHistory(int fish_capacity) :
+  fish(static_cast<size_t>(fish_capacity * HISTORY_FRAMES)),
+  capacity(fish_capacity)
+{
+}
+
+/**
+ *   @brief   Starts recording the frame being drawn
+ *   @details Reuses the slot of the oldest frame.
+ *   @return  Room for the frame's fish, to be filled by the caller.
+ */
+
+FrameHistory::Fish* FrameHistory::record(int fish_count)
+{
+  newest_frame = (newest_frame + 1) % HISTORY_FRAMES;
+  Frame& frame = frames[newest_frame];
+  frame.on_screen = false;
+  frame.fish_count = fish_count < capacity ? fish_count : capacity;
+  frame.fish = fish.data() + static_cast<size_t>(newest_frame * capacity);
+  return frame.fish;
+}
+
+/**
+ *   @brief   Stamps the newest frame as on screen from now
+ *   @details Only the first call after a frame is recorded counts, a
+ *            frame that was already presented keeps its time.
+ */
+
+void FrameHistory::presented(Clock::time_point when)
+{
+  if (newest_frame < 0 || frames[newest_frame].on_screen)
+  {
+    return;
+  }
+  frames[newest_frame].presented = when;
+  frames[newest_frame].on_screen = true;
+}
+
+/**
+ *   @brief   Finds the frame that was on screen at a point in time
+ *   @details The newest frame presented at or before the time. A time
+ *            older than the history gets the oldest frame kept.
+ *   @return  nullptr if no frame has been presented yet.
+ */
+
+const FrameHistory::Frame* FrameHistory::shownAt(Clock::time_point when) const
+{
+  const Frame* oldest = nullptr;
+  for (int age = 0; age < HISTORY_FRAMES && newest_frame >= 0; age++)
+  {
+    const Frame& frame =
+      frames[(newest_frame - age + HISTORY_FRAMES) % HISTORY_FRAMES];
+    if (!frame.on_screen)
+    {
+      continue;
+    }
+    if (frame.presented <= when)
+    {
+      return &frame;
+    }
+    oldest = &frame;
+  }
+  return oldest;
+}
+
+size_t FrameHistory::bytes() const
+{
+  return fish.capacity() * sizeof(Fish) + sizeof(frames);
+}
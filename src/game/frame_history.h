@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  Where every fish was drawn in each of the last few frames, and when
+ *  each of those frames reached the screen. A click is tested against
+ *  the frame that was showing when it was made, not whichever frame
+ *  was drawn after it. The ring is sized up front, recording a frame
+ *  only writes the fish in use and never allocates.
+ */
+class FrameHistory
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum
+  {
+    HISTORY_FRAMES = 4
+  };
+
+  /**
+   *  A fish as one frame drew it.
+   */
+  struct Fish
+  {
+    float x = 0;
+    float y = 0;
+    std::int32_t spawn = 0;   /**< Which fish the slot held. */
+    std::uint16_t size = 0;
+    bool flipped_x = false;
+    bool visible = false;
+  };
+
+  struct Frame
+  {
+    Clock::time_point presented;
+    bool on_screen = false; /**< False until the frame is presented. */
+    int fish_count = 0;
+    Fish* fish = nullptr;
+  };
+
+  explicit FrameHistory(int fish_capacity);
+
+  Fish* record(int fish_count);
+  void presented(Clock::time_point when);
+  const Frame* shownAt(Clock::time_point when) const;
+
+  size_t bytes() const;
+
+ private:
+  std::vector<Fish> fish;
+  Frame frames[HISTORY_FRAMES];
+  int newest_frame = -1;
+  int capacity = 0;
+};
@@ -0,0 +1,110 @@
+#include <thread>
+
+#include "frame_pacer.h"
+
+enum
+{
+  SPIN_MARGIN_US = 1500,
+  IDLE_DELAY_MS = 2000
+};
+
+FramePacer::FramePacer(int target, int heartbeat) :
+  target_fps(target), heartbeat_fps(heartbeat)
+{
+}
+
+/**
+ *   @brief   Sets the frame rate used while the game is active
+ *   @details A target of zero or less leaves the loop unpaced.
+ */
+
+void FramePacer::targetFPS(int fps)
+{
+  target_fps = fps;
+}
+
+void FramePacer::heartbeatFPS(int fps)
+{
+  heartbeat_fps = fps;
+}
+
+/**
+ *   @brief   Allows the pacer to drop to the heartbeat rate
+ *   @details Idling only starts once no input was seen for a short
+ *            while, so menu navigation stays at the full rate.
+ */
+
+void FramePacer::allowIdle(bool allowed)
+{
+  idle_allowed = allowed;
+}
+
+/**
+ *   @brief   Leaves idle mode after input
+ *   @details Input is only seen when the engine polls events, after
+ *            wait() has slept out the heartbeat period, so input that
+ *            arrives while idle can be up to one heartbeat late. From
+ *            then on the frames are paced at the target rate again.
+ */
+
+void FramePacer::wake()
+{
+  last_input = Clock::now();
+  if (idle)
+  {
+    deadline = last_input;
+    idle = false;
+  }
+}
+
+/**
+ *   @brief   Blocks until the next frame is due
+ *   @details Sleeps until shortly before the deadline and spins out
+ *            the remainder. A late frame moves the deadline forward
+ *            rather than rushing the following frames to catch up.
+ */
+
+void FramePacer::wait()
+{
+  auto now = Clock::now();
+  idle = idle_allowed &&
+         now - last_input > std::chrono::milliseconds(IDLE_DELAY_MS);
+
+  auto frame = period(idle ? heartbeat_fps : target_fps);
+  if (frame == Clock::duration::zero())
+  {
+    deadline = now;
+    return;
+  }
+
+  deadline += frame;
+  if (deadline <= now)
+  {
+    deadline = now;
+    return;
+  }
+  if (deadline - now > frame)
+  {
+    deadline = now + frame;
+  }
+
+  auto spin_from = deadline - std::chrono::microseconds(SPIN_MARGIN_US);
+  if (now < spin_from)
+  {
+    std::this_thread::sleep_until(spin_from);
+  }
+  while (Clock::now() < deadline)
+  {
+    std::this_thread::yield();
+  }
+}
+
+FramePacer::Clock::duration FramePacer::period(int fps)
+{
+  if (fps <= 0)
+  {
+    return Clock::duration::zero();
+  }
+  return std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(1.0 / fps));
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <chrono>
+
+/**
+ *  Paces the game loop to a target frame rate.
+ *  Waits by sleeping for most of the remaining frame time and spinning
+ *  for the last part, as sleeps alone overshoot by a scheduler quantum.
+ *  While idle it drops to a low heartbeat until input arrives, which
+ *  delays idle input by up to one heartbeat period.
+ */
+class FramePacer
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  FramePacer(int target_fps, int heartbeat_fps);
+
+  void targetFPS(int fps);
+  int targetFPS() const { return target_fps; }
+  void heartbeatFPS(int fps);
+  void allowIdle(bool idle_allowed);
+  void wake();
+  void wait();
+  bool idling() const { return idle; }
+
+ private:
+  static Clock::duration period(int fps);
+
+  int target_fps = 0;
+  int heartbeat_fps = 0;
+  bool idle_allowed = false;
+  bool idle = false;
+  Clock::time_point deadline = Clock::now();
+  Clock::time_point last_input = Clock::now();
+};
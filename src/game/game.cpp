@@ -1,14 +1,22 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <memory>
+#include <sstream>
 #include <string>
 
-#include <Engine/DebugPrinter.h>
 #include <Engine/Input.h>
 #include <Engine/InputEvents.h>
 #include <Engine/Keys.h>
 #include <Engine/Sprite.h>
 
 #include "game.h"
+#include "logger.h"
+#include "trace_recorder.h"
 
 enum
 {
@@ -16,20 +24,14 @@ enum
   WINDOWY = 720,
   DISTANCE_BETWEEN_CHOICES = 120,
   AVERAGE_FONT_LENGTH = 5,
-  CLOWNFISH_STANDARD_SIZE_MIN = 50,
-  CLOWNFISH_STANDARD_SIZE_MAX = 64,
-  CLOWNFISH_SMALL_SIZE_MIN = 40,
-  CLOWNFISH_SMALL_SIZE_MAX = 48,
-  CLOWNFISH_TINY_SIZE_MIN = 32,
-  CLOWNFISH_TINY_SIZE_MAX = 38,
   MENU_MIN = 0,
-  MENU_MAX = 2,
-  STANDARD_SPEED_MIN = 100,
-  STANDARD_SPEED_MAX = 200,
-  FAST_SPEED_MIN = 250,
-  FAST_SPEED_MAX = 400,
-  FASTER_SPEED_MIN = 600,
-  FASTER_SPEED_MAX = 800,
+  MENU_MAX = 3,
+  MENU_ENDLESS = 2,
+  MENU_EXIT = 3,
+  ENDLESS_GAMEMODE = 2,
+  START_FISHCOUNT = 2,
+  ENDLESS_FISH_PER_BRACKET = 4,
+  ENDLESS_GATE_GROWTH_PERCENT = 115,
   STANDARD_FISH = 0,
   FAST_FISH = 1,
   ANGLED_FISH = 2,
@@ -39,19 +41,80 @@ enum
   TURNING_FISH = 6,
   ULTIMATE_FISH = 7,
   SCORE_Y_LOCATION = 40,
-  SPECIAL_POWER_GAIN = 200,
-  LIFE_LOSS = 10
+  HUD_X_LOCATION = 10,
+  HUD_Y_OFFSET = 30,
+  HUD_LINE_HEIGHT = 16,
+  TARGET_FPS = 120,
+  IDLE_HEARTBEAT_FPS = 10,
+  HEADLESS_FRAME_MS = 16,
+  HEADLESS_CLICK_INTERVAL = 20,
+  HEADLESS_WARMUP_FRAMES = 120,
+  INPUT_QUEUE_RESERVE = 64,
+  CLICK_LOGS_PER_SECOND = 4,
+  PARTICLE_CAPACITY = 32768,
+  PARTICLE_SIZE = 4,
+  ARENA_SPRITE_COUNT = MAX_FISHCOUNT + 3
 };
 
+// types spawned with an angle of 1 that no ability changes, so only
+// schooling moves them up or down
+const bool TYPE_HORIZONTAL[FISH_TYPE_COUNT] = { true,  true,  false, false,
+                                                true,  true,  false, false };
+// types given an ability timer
+const bool TYPE_HAS_ABILITY[FISH_TYPE_COUNT] = { false, false, false, true,
+                                                 false, true,  true,  true };
+
+using WorkClock = std::chrono::steady_clock;
+using Millis = std::chrono::duration<double, std::milli>;
+
+const ParticleSystem::Burst CATCH_BURST = {
+  48, 60, 260, 40, 300, 0.7f, ASGE::COLOURS::DARKORANGE
+};
+const ParticleSystem::Burst ULTIMATE_CATCH_BURST = {
+  96, 80, 360, 40, 300, 0.9f, ASGE::COLOURS::CORAL
+};
+const ParticleSystem::Burst MISS_BURST = {
+  16, 10, 50, 60, -20, 0.8f, ASGE::COLOURS::ALICEBLUE
+};
+
+/**
+ *   @brief   The next value of the session's random sequence
+ *   @details Replaces std::rand, whose state every game in the process
+ *            would share. Always in [1, 2^31 - 2].
+ */
+
+int MyASGEGame::nextRandom()
+{
+  return static_cast<int>(rng());
+}
+
+/**
+ *   @brief   Rolls a random value in a tuned range
+ */
+
+int MyASGEGame::roll(const TuningRange& range)
+{
+  return range.min + (nextRandom() % (range.max - range.min));
+}
+
 /**
  *   @brief   Default Constructor.
  *   @details Consider setting the game's width and height
  *            and even seeding the random number generator.
  */
 
-MyASGEGame::MyASGEGame()
+MyASGEGame::MyASGEGame() :
+  shown_frames(MAX_FISHCOUNT),
+  ability_scheduler(MAX_FISHCOUNT),
+  school(MAX_FISHCOUNT, WINDOWX, WINDOWY),
+  sprites(ARENA_SPRITE_COUNT),
+  particles(PARTICLE_CAPACITY),
+  tuning(TuningSet::build(Tuning(), 0)),
+  frame_pacer(TARGET_FPS, IDLE_HEARTBEAT_FPS)
 {
   game_name = "Not a Nemo game by Csongor-Zsolt Horosnyi";
+  queued_input.reserve(INPUT_QUEUE_RESERVE);
+  governor.budget(1000.0 / TARGET_FPS);
 }
 
 /**
@@ -61,10 +124,39 @@ MyASGEGame::MyASGEGame()
 
 MyASGEGame::~MyASGEGame()
 {
-  this->inputs->unregisterCallback(static_cast<unsigned int>(key_callback_id));
+  sim_pipeline.stop();
+
+  // a game that was never initialised has no input system
+  if (this->inputs != nullptr)
+  {
+    this->inputs->unregisterCallback(
+      static_cast<unsigned int>(key_callback_id));
+
+    this->inputs->unregisterCallback(
+      static_cast<unsigned int>(mouse_callback_id));
+
+    this->inputs->unregisterCallback(
+      static_cast<unsigned int>(receipt_callback_id));
+  }
+
+  std::ostringstream report;
+  report << "Click latency report\n";
+  latency.dump(report);
+  report << "Memory report\n";
+  memory.dump(report);
+  report << "Allocation report\n";
+  allocations.dump(report);
+  report << "Frame governor report\n";
+  governor.dump(report);
+  telemetry.endSession(score, difficulty_state);
+  if (TraceRecorder::enabled())
+  {
+    report << "Trace written to " << TraceRecorder::stop() << "\n";
+  }
+  Logger::lines(Logger::LEVEL_INFO, report.str());
 
-  this->inputs->unregisterCallback(
-    static_cast<unsigned int>(mouse_callback_id));
+  // the sprites go before the renderer the base class owns
+  sprites.clear();
 }
 
 /**
@@ -84,239 +176,685 @@ bool MyASGEGame::init()
   }
 
   toggleFPS();
+  return initGame();
+}
+
+/**
+ *   @brief   Initialises the game without a window
+ *   @details Swaps in the recording NullRenderer and its input system
+ *            in place of the OpenGL ones, then loads the game as usual.
+ *            Frame pacing is disabled, headless runs go flat out.
+ *   @return  True if the game initialised correctly.
+ */
+
+bool MyASGEGame::initHeadless()
+{
+  setupResolution();
+  auto null_renderer = std::make_unique<NullRenderer>();
+  null_renderer->shareAssets(assets);
+  headless_renderer = null_renderer.get();
+  renderer = std::move(null_renderer);
+  inputs = renderer->inputPtr();
+  if (!inputs->init(renderer.get()))
+  {
+    return false;
+  }
+
+  frame_pacer.targetFPS(0);
+  // the bot's events are made here, so its clicks never allocate
+  bot_enter = std::make_shared<ASGE::KeyEvent>();
+  bot_enter->key = ASGE::KEYS::KEY_ENTER;
+  bot_enter->action = ASGE::KEYS::KEY_RELEASED;
+  bot_click = std::make_shared<ASGE::ClickEvent>();
+  bot_click->action = ASGE::MOUSE::BUTTON_PRESSED;
+  bot_click->button = ASGE::MOUSE::MOUSE_BTN1;
+  return initGame();
+}
+
+/**
+ *   @brief   Loads the assets and state shared by every backend
+ *   @details Registers the input callbacks and creates the sprites
+ *            through whichever renderer is active.
+ *   @return  True if the game initialised correctly.
+ */
+
+bool MyASGEGame::initGame()
+{
+  TraceRecorder::nameThread("game");
+  TRACE_SCOPE("initGame", "init");
+  // a hosted session is handed its tuning by the host
+  if (assets == nullptr)
+  {
+    TRACE_SCOPE("loadTuning", "init");
+    tuning = tuning_watcher.start(tuning_file);
+  }
 
   // input handling functions
   inputs->use_threads = false;
 
-  renderer->setSpriteMode(ASGE::SpriteSortMode::IMMEDIATE);
+  // sprites sharing a texture are batched until the texture changes
+  renderer->setSpriteMode(ASGE::SpriteSortMode::DEFERRED);
 
   key_callback_id =
     inputs->addCallbackFnc(ASGE::E_KEY, &MyASGEGame::keyHandler, this);
 
+  // registered before clickHandler so it sees every click first
+  receipt_callback_id = inputs->addCallbackFnc(
+    ASGE::E_MOUSE_CLICK, &MyASGEGame::clickReceiptHandler, this);
+
   mouse_callback_id = inputs->addCallbackFnc(
     ASGE::E_MOUSE_CLICK, &MyASGEGame::clickHandler, this);
 
   if (initBackground())
   {
-    ASGE::DebugPrinter{} << "init::Background init success" << std::endl;
+    LOG_INFO("init::Background init success");
   }
   else
     return false;
   if (initClownfish())
   {
-    ASGE::DebugPrinter{} << "init::Clownfish init success" << std::endl;
+    LOG_INFO("init::Clownfish init success");
   }
   else
     return false;
   if (initLifeBar())
   {
-    ASGE::DebugPrinter{} << "init::Life_bar init success" << std::endl;
+    LOG_INFO("init::Life_bar init success");
+  }
+  else
+    return false;
+  if (initParticles())
+  {
+    LOG_INFO("init::Particles init success");
   }
   else
     return false;
   life_bar->yPos(WINDOWY - 20);
-  std::srand(std::time(0));
+  if (!seeded)
+  {
+    rng.seed(static_cast<std::minstd_rand::result_type>(std::time(nullptr)));
+  }
   gameStateInit();
+  publishSnapshot();
+  sim_pipeline.start([this] { simulate(); }, sim_threaded);
+  AllocTracker::discard();
   return true;
 }
 
+/**
+ *   @brief   Sets the tuning file loaded and watched by init
+ */
+
+void MyASGEGame::tuningFile(const std::string& path)
+{
+  tuning_file = path;
+}
+
+/**
+ *   @brief   Picks whether the simulation runs on its own thread
+ *   @details Either way render draws the tick before the one being
+ *            simulated, so both modes play the same. Set before init.
+ */
+
+void MyASGEGame::pipelined(bool threaded)
+{
+  sim_threaded = threaded;
+}
+
+/**
+ *   @brief   Publishes the live state to a shared memory object
+ *   @details Written once a frame from render, see StateExport.
+ *   @return  false if the object could not be created.
+ */
+
+bool MyASGEGame::exportLiveState(const std::string& name)
+{
+  return live_state.open(name);
+}
+
+/**
+ *   @brief   Applies the command line options
+ *   @details Call before init. Options left at their defaults leave
+ *            the game's own settings alone.
+ */
+
+void MyASGEGame::configure(const GameOptions& options)
+{
+  if (options.target_fps >= 0)
+  {
+    targetFPS(options.target_fps);
+  }
+  if (options.frame_budget_ms >= 0)
+  {
+    frameBudget(options.frame_budget_ms);
+  }
+  if (options.alloc_budget >= 0)
+  {
+    allocationBudget(options.alloc_budget);
+  }
+  if (options.endless)
+  {
+    endlessMode();
+  }
+  if (options.serial)
+  {
+    pipelined(false);
+  }
+  if (options.seeded)
+  {
+    seed(options.seed);
+  }
+  tuningFile(options.tuning_file);
+  render_check = options.render_check;
+  if (!options.export_name.empty())
+  {
+    exportLiveState(options.export_name);
+  }
+}
+
+/**
+ *   @brief   Sets the frame rate the game is paced to
+ *   @details Zero or less runs the game loop unpaced.
+ */
+
+void MyASGEGame::targetFPS(int fps)
+{
+  frame_pacer.targetFPS(fps);
+}
+
+/**
+ *   @brief   Sets the time the work of a frame may take
+ *   @details The frame governor lowers particle and schooling detail,
+ *            and holds back new fish in endless games, to stay inside
+ *            it. Zero or less turns the governor off.
+ */
+
+void MyASGEGame::frameBudget(double frame_ms)
+{
+  governor.budget(frame_ms);
+}
+
+/**
+ *   @brief   Preselects Endless on the menu
+ *   @details Enter, or the headless bot, then starts an endless game.
+ */
+
+void MyASGEGame::endlessMode()
+{
+  menu_option = MENU_ENDLESS;
+}
+
+/**
+ *   @brief   Runs the game loop without a window
+ *   @details Drives update and render with a fixed delta, the same way
+ *            the engine loop would. A bot starts a sandbox game and
+ *            clicks regularly, alternating hits and misses, so the
+ *            input paths are part of the measured frames.
+ *   @param   frames The number of frames to simulate.
+ *   @return  False if a steady-state frame went over the allocation
+ *            budget, or the render check failed.
+ */
+
+bool MyASGEGame::runHeadless(int frames)
+{
+  using Clock = std::chrono::steady_clock;
+  ASGE::GameTime game_time;
+  game_time.delta =
+    std::chrono::duration<double, std::milli>(HEADLESS_FRAME_MS);
+  game_time.elapsed = std::chrono::milliseconds(0);
+  Clock::duration update_time{};
+  Clock::duration render_time{};
+
+  for (int frame = 0; frame < frames; frame++)
+  {
+    headlessBotInput(frame);
+
+    auto start = Clock::now();
+    update(game_time);
+    auto updated = Clock::now();
+    renderer->preRender();
+    render(game_time);
+    renderer->postRender();
+    renderer->swapBuffers();
+    auto rendered = Clock::now();
+
+    update_time += updated - start;
+    render_time += rendered - updated;
+    game_time.elapsed += std::chrono::milliseconds(HEADLESS_FRAME_MS);
+  }
+
+  if (frames > 0)
+  {
+    using Micros = std::chrono::duration<double, std::micro>;
+    LOG_INFO("headless: {} frames, update {}us/frame, render {}us/frame, "
+             "{} sprites/frame",
+             frames,
+             Micros(update_time).count() / frames,
+             Micros(render_time).count() / frames,
+             headless_renderer->totalSpriteDraws() / frames);
+  }
+
+  bool passed = true;
+  if (alloc_budget_set)
+  {
+    std::ostringstream report;
+    report << "headless allocations\n";
+    allocations.dump(report);
+    Logger::lines(Logger::LEVEL_INFO, report.str());
+    if (!AllocTracker::instrumented())
+    {
+      LOG_ERROR("headless: allocation budget needs a TRACK_ALLOCATIONS "
+                "build");
+      return false;
+    }
+    passed = allocations.withinBudget();
+  }
+  if (render_check && !checkRender(game_time))
+  {
+    passed = false;
+  }
+  return passed;
+}
+
+/**
+ *   @brief   Checks one recorded headless frame against the game state
+ *   @details Runs a frame with the null renderer recording, then checks
+ *            the background went first, every visible fish was drawn
+ *            once where its motion puts it, with its size, flip and
+ *            colour, no culled fish was drawn, and the score shown is
+ *            the score.
+ *   @return  False, with the first mismatch logged, if the frame is
+ *            not what the state says it should be.
+ */
+
+bool MyASGEGame::checkRender(const ASGE::GameTime& game_time)
+{
+  headless_renderer->recordDraws(true);
+  update(game_time);
+  renderer->preRender();
+  render(game_time);
+  renderer->postRender();
+  renderer->swapBuffers();
+  headless_renderer->recordDraws(false);
+
+  const auto& draws = headless_renderer->spriteDraws();
+  if (draws.empty() || draws.front().sprite != background)
+  {
+    LOG_ERROR("render check: the background was not drawn first");
+    return false;
+  }
+
+  const Snapshot& snapshot = snapshots[front_snapshot];
+  bool fish_shown = !in_menu || attract_mode;
+  int fish_drawn = 0;
+  for (int i = 0; i < snapshot.fish_count; i++)
+  {
+    const FishView& fish = snapshot.fish[i];
+    auto size = static_cast<float>(fish.size);
+    float x = fish.motion.x(snapshot.time, WINDOWX);
+    float y = fish.motion.y(snapshot.time, WINDOWY);
+    bool visible =
+      fish_shown && x + size > 0 && x < WINDOWX && y + size > 0 && y < WINDOWY;
+    ASGE::Colour colour = fish.type == ULTIMATE_FISH ? ASGE::COLOURS::CORAL
+                                                     : ASGE::COLOURS::WHITE;
+
+    int count = 0;
+    for (const auto& draw : draws)
+    {
+      if (draw.sprite != clownfish[i])
+      {
+        continue;
+      }
+      count++;
+      if (std::abs(draw.x - x) > 0.01f || std::abs(draw.y - y) > 0.01f ||
+          draw.width != size || draw.height != size ||
+          draw.flipped_x == fish.x_negative || draw.colour.r != colour.r ||
+          draw.colour.g != colour.g || draw.colour.b != colour.b)
+      {
+        LOG_ERROR("render check: fish {} drawn at {},{} size {}",
+                  i,
+                  draw.x,
+                  draw.y,
+                  draw.width);
+        LOG_ERROR("render check: expected {},{} size {}", x, y, size);
+        return false;
+      }
+    }
+    if (count != (visible ? 1 : 0))
+    {
+      LOG_ERROR("render check: fish {} drawn {} times, expected {}",
+                i,
+                count,
+                visible ? 1 : 0);
+      return false;
+    }
+    fish_drawn += count;
+  }
+
+  if (!in_menu)
+  {
+    std::string score_text = score_fluff + std::to_string(score);
+    const auto& texts = headless_renderer->textDraws();
+    auto shows_score = [&](const NullRenderer::TextDraw& text) {
+      return text.text == score_text;
+    };
+    if (std::none_of(texts.begin(), texts.end(), shows_score))
+    {
+      LOG_ERROR("render check: \"{}\" was not drawn", score_text);
+      return false;
+    }
+  }
+  LOG_INFO("render check: passed, {} of {} fish drawn",
+           fish_drawn,
+           snapshot.fish_count);
+  return true;
+}
+
+/**
+ *   @brief   Sets the allocation budget checked by runHeadless
+ *   @details Gameplay frames after HEADLESS_WARMUP_FRAMES that make
+ *            more heap allocations than this fail the run.
+ */
+
+void MyASGEGame::allocationBudget(long allocations_per_frame)
+{
+  allocations.budget(allocations_per_frame, HEADLESS_WARMUP_FRAMES);
+  alloc_budget_set = true;
+}
+
+/**
+ *   @brief   Runs one headless frame for a session host
+ *   @details The same frame runHeadless runs, bot input included,
+ *            without the timing. The host owns the clock.
+ *   @param   frame The session's frame number, 0 starts the game.
+ */
+
+void MyASGEGame::stepHeadless(int frame, const ASGE::GameTime& game_time)
+{
+  headlessBotInput(frame);
+  update(game_time);
+  renderer->preRender();
+  render(game_time);
+  renderer->postRender();
+  renderer->swapBuffers();
+}
+
+/**
+ *   @brief   Makes the game use assets loaded once for many sessions
+ *   @details The game then also leaves tuning to whoever hosts it, see
+ *            retune. Set before initHeadless, the store must outlive
+ *            the game.
+ */
+
+void MyASGEGame::shareAssets(const AssetStore* store)
+{
+  assets = store;
+}
+
+/**
+ *   @brief   Makes the game write its telemetry on a shared thread
+ *   @details Set before the first session starts, the writer must
+ *            outlive closeTelemetry.
+ */
+
+void MyASGEGame::shareTelemetry(TelemetryWriter* writer)
+{
+  telemetry.shareWriter(writer);
+}
+
+/**
+ *   @brief   Seeds the session's random numbers
+ *   @details Unseeded games are seeded from the clock by init.
+ */
+
+void MyASGEGame::seed(unsigned value)
+{
+  rng.seed(value);
+  seeded = true;
+}
+
+/**
+ *   @brief   Swaps in a tuning set loaded by the host
+ *   @details Only between frames, like a set from the tuning watcher.
+ *            Abilities already charging pick up a new power gain.
+ */
+
+void MyASGEGame::retune(std::shared_ptr<const TuningSet> set)
+{
+  if (tuning == nullptr)
+  {
+    tuning = std::move(set);
+    return;
+  }
+  int old_gain = tuning->params.special_power_gain;
+  tuning = std::move(set);
+  retimeAbilities(old_gain);
+}
+
+/**
+ *   @brief   Finishes the telemetry file and waits for it to be written
+ *   @details Destroying any game shuts the engine's file system down
+ *            for every game in the process, so a host calls this on
+ *            all of its sessions before it destroys the first one.
+ */
+
+void MyASGEGame::closeTelemetry()
+{
+  telemetry.endSession(score, difficulty_state);
+  telemetry.stop();
+}
+
+/**
+ *   @brief   Feeds scripted input to a headless run
+ *   @details Presses enter on the first frame to start a sandbox game,
+ *            then clicks every HEADLESS_CLICK_INTERVAL frames. The
+ *            events are made once by initHeadless and resent, so the
+ *            bot adds no allocations to the frames it measures.
+ */
+
+void MyASGEGame::headlessBotInput(int frame)
+{
+  if (frame == 0)
+  {
+    inputs->sendEvent(ASGE::E_KEY, bot_enter);
+    return;
+  }
+  if (frame % HEADLESS_CLICK_INTERVAL != 0)
+  {
+    return;
+  }
+
+  // the last click was applied by the update after it was sent
+  ASGE::ClickEvent* click = bot_click.get();
+  // the bot aims at the frame on screen, like a player would
+  const FrameHistory::Frame* shown =
+    shown_frames.shownAt(FrameHistory::Clock::now());
+  if (shown != nullptr && shown->fish_count > 0 &&
+      (frame / HEADLESS_CLICK_INTERVAL) % 2 == 0)
+  {
+    int target = (frame / HEADLESS_CLICK_INTERVAL) % shown->fish_count;
+    const FrameHistory::Fish& fish = shown->fish[target];
+    click->xpos = fish.x + fish.size / 2.0;
+    click->ypos = fish.y + fish.size / 2.0;
+  }
+  else
+  {
+    click->xpos = -1;
+    click->ypos = -1;
+  }
+  inputs->sendEvent(ASGE::E_MOUSE_CLICK, bot_click);
+}
+
 void MyASGEGame::gameStateInit()
 {
-  fish_count = 2;
+  fish_count = START_FISHCOUNT;
   difficulty_state = 0;
+  ability_scheduler.clear();
   createFish(STANDARD_FISH, 0);
   createFish(STANDARD_FISH, 1);
   score = 0;
+  accountMemory();
+}
+
+/**
+ *   @brief   Fills in the memory ledger for the session
+ *   @details Everything counted is allocated once at init, so the
+ *            figures should not change from one session to the next.
+ */
+
+void MyASGEGame::accountMemory()
+{
+  memory.begin();
+  memory.add(MemoryLedger::FISH,
+             sizeof(fishes) + sizeof(snapshots) + sizeof(sprite_state) +
+               shown_frames.bytes() + school.bytes() +
+               ability_scheduler.bytes());
+  memory.add(MemoryLedger::SPRITES,
+             sprites.spriteBytes() + sizeof(clownfish));
+  memory.add(MemoryLedger::TEXTURES, sprites.textureBytes());
+  memory.add(MemoryLedger::TEXT,
+             welcome.capacity() + score_fluff.capacity() +
+               latency.hudText().capacity() + memory.hudText().capacity());
+  memory.add(MemoryLedger::EFFECTS, particles.bytes());
+  memory.end();
+}
+
+/**
+ *   @brief   Turns the menu's attract screen on or off
+ *   @details The attract screen fills the menu background with a
+ *            school of SCHOOL_FISHCOUNT fish of every type.
+ */
+
+void MyASGEGame::attractMode(bool enabled)
+{
+  attract_mode = enabled;
+  if (in_menu)
+  {
+    if (attract_mode)
+    {
+      attractInit();
+    }
+    else
+    {
+      gameStateInit();
+    }
+  }
+}
+
+void MyASGEGame::attractInit()
+{
+  ability_scheduler.clear();
+  fish_count = SCHOOL_FISHCOUNT;
+  for (int i = 0; i < fish_count; i++)
+  {
+    createFish(nextRandom() % FISH_TYPE_COUNT, i);
+  }
 }
 
 /**
  *   @brief   Picks a fish to spawn
- *   @details Builds a new pool of fish based on difficulty after
- *            checking difficulty. Then adds a 25% chance to re-spawn
- *            the fish that was just clicked, if it receives a
- *            true boolean value.
+ *   @details Rolls against the spawn weights of the difficulty after
+ *            checking difficulty, using the cumulative tables of the
+ *            current TuningSet. If it receives a true boolean value the
+ *            fish that was just clicked gets the tuned stay bonus.
  *   @return  The ID of the fish that was chosen
  */
 
 int MyASGEGame::fishChoice(int type_lost, bool chance_to_stay)
 {
-  int fish_to_spawn = -1;
-  int random_counter = std::rand();
+  int random_counter = nextRandom();
 
   difficultyCalculation();
-  fishPoolConstructor(difficulty_state);
 
-  if (chance_to_stay)
+  int bonus_type = chance_to_stay ? type_lost : -1;
+  random_counter =
+    random_counter % tuning->spawnRange(difficulty_state, bonus_type);
+  random_counter++;
+  return tuning->spawnType(difficulty_state, bonus_type, random_counter);
+}
+
+/**
+ *   @brief   Checks Score against the difficulty gate
+ *   @details Checks if the score surpassed the current difficulty gate
+ *            then adds a new fish and raises difficulty if it was.
+ *            Only endless games go past the last bracket of the
+ *            tuning, their fish are added by growFish.
+ */
+
+void MyASGEGame::difficultyCalculation()
+{
+  if ((gamemode == ENDLESS_GAMEMODE ||
+       difficulty_state < DIFFICULTY_BRACKET_COUNT) &&
+      score >= difficultyGate(difficulty_state))
   {
-    fish_pool[type_lost] += 25;
-    random_counter = random_counter % 100;
-    random_counter++;
+    difficulty_state++;
+    telemetry.difficulty(difficulty_state, score);
+    if (gamemode != ENDLESS_GAMEMODE)
+    {
+      fish_count++;
+      createFish(fishChoice(0, false), fish_count - 1);
+    }
   }
-  else
+}
+
+/**
+ *   @brief   The score that raises difficulty past a bracket
+ *   @details Brackets past the tuning's gates are made up as they are
+ *            reached, each step ENDLESS_GATE_GROWTH_PERCENT of the one
+ *            before it.
+ *   @return  The gate, at most INT_MAX.
+ */
+
+int MyASGEGame::difficultyGate(int bracket) const
+{
+  const int* gates = tuning->params.difficulty_gates;
+  if (bracket < DIFFICULTY_BRACKET_COUNT)
   {
-    random_counter = random_counter % 75;
-    random_counter++;
+    return gates[bracket];
   }
-
-  for (int i = 0; i < FISH_TYPE_COUNT && fish_to_spawn == -1; i++)
+  long long gate = gates[DIFFICULTY_BRACKET_COUNT - 1];
+  long long step = gate - gates[DIFFICULTY_BRACKET_COUNT - 2];
+  for (int i = DIFFICULTY_BRACKET_COUNT; i <= bracket && gate < INT_MAX; i++)
   {
-    if (fish_pool[i] >= random_counter)
-    {
-      fish_to_spawn = i;
-    }
-    random_counter -= fish_pool[i];
+    step = step * ENDLESS_GATE_GROWTH_PERCENT / 100;
+    gate += step;
   }
-  return fish_to_spawn;
+  return static_cast<int>(std::min(gate, static_cast<long long>(INT_MAX)));
 }
 
 /**
- *   @brief   Checks Score against the difficulty gate
- *   @details Checks if the score surpassed the current difficulty gate
- *            then adds a new fish and raises difficulty if it was.
+ *   @brief   How many fish an endless game's bracket plays with
+ *   @details One more per bracket of the tuning, as in the other
+ *            modes, then ENDLESS_FISH_PER_BRACKET more per bracket.
  */
 
-void MyASGEGame::difficultyCalculation()
+int MyASGEGame::targetFishCount() const
 {
-  if (difficulty_state < DIFFICULTY_BRACKET_COUNT &&
-      score >= difficulty_limits[difficulty_state])
-  {
-    difficulty_state++;
-    fish_count++;
-    createFish(fishChoice(0, false), fish_count - 1);
-  }
+  int tuned =
+    std::min(difficulty_state, static_cast<int>(DIFFICULTY_BRACKET_COUNT));
+  long long target = START_FISHCOUNT + tuned +
+                     static_cast<long long>(ENDLESS_FISH_PER_BRACKET) *
+                       (difficulty_state - tuned);
+  return static_cast<int>(
+    std::min(target, static_cast<long long>(MAX_FISHCOUNT)));
 }
 
 /**
- *   @brief   Rebuilds the fish_pool based on current difficulty
- *   @details Chooses which types of fish have a chance to spawn.
- *            The total in a pool should add up to 75.
+ *   @brief   Adds a fish to an endless game short of its bracket's
+ *   @details At most one a frame, and only while the frame governor
+ *            has time to spare, so a population the machine cannot
+ *            keep up with stops growing instead.
  */
 
-void MyASGEGame::fishPoolConstructor(int difficulty_progress)
+void MyASGEGame::growFish()
 {
-  switch (difficulty_progress)
+  if (in_menu || gamemode != ENDLESS_GAMEMODE ||
+      fish_count >= targetFishCount() || !governor.allowSpawn())
   {
-    case 0:
-      fish_pool[0] = 75; // Standard
-      fish_pool[1] = 0;  // Fast
-      fish_pool[2] = 0;  // Angled
-      fish_pool[3] = 0;  // Angled Fast
-      fish_pool[4] = 0;  // Faster
-      fish_pool[5] = 0;  // Slippery
-      fish_pool[6] = 0;  // Turning
-      fish_pool[7] = 0;  // Ultimate
-      break;
-    case 1:
-      fish_pool[0] = 50;
-      fish_pool[1] = 25;
-      fish_pool[2] = 0;
-      fish_pool[3] = 0;
-      fish_pool[4] = 0;
-      fish_pool[5] = 0;
-      fish_pool[6] = 0;
-      fish_pool[7] = 0;
-      break;
-    case 2:
-      fish_pool[0] = 20;
-      fish_pool[1] = 45;
-      fish_pool[2] = 10;
-      fish_pool[3] = 0;
-      fish_pool[4] = 0;
-      fish_pool[5] = 0;
-      fish_pool[6] = 0;
-      fish_pool[7] = 0;
-      break;
-    case 3:
-      fish_pool[0] = 0;
-      fish_pool[1] = 30;
-      fish_pool[2] = 30;
-      fish_pool[3] = 15;
-      fish_pool[4] = 0;
-      fish_pool[5] = 0;
-      fish_pool[6] = 0;
-      fish_pool[7] = 0;
-      break;
-    case 4:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 10;
-      fish_pool[3] = 35;
-      fish_pool[4] = 20;
-      fish_pool[5] = 10;
-      fish_pool[6] = 0;
-      fish_pool[7] = 0;
-      break;
-    case 5:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 0;
-      fish_pool[3] = 20;
-      fish_pool[4] = 10;
-      fish_pool[5] = 35;
-      fish_pool[6] = 10;
-      fish_pool[7] = 0;
-      break;
-    case 6:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 0;
-      fish_pool[3] = 20;
-      fish_pool[4] = 10;
-      fish_pool[5] = 20;
-      fish_pool[6] = 25;
-      fish_pool[7] = 0;
-      break;
-    case 7:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 0;
-      fish_pool[3] = 20;
-      fish_pool[4] = 0;
-      fish_pool[5] = 25;
-      fish_pool[6] = 25;
-      fish_pool[7] = 5;
-      break;
-    case 8:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 0;
-      fish_pool[3] = 20;
-      fish_pool[4] = 0;
-      fish_pool[5] = 20;
-      fish_pool[6] = 20;
-      fish_pool[7] = 15;
-      break;
-    case 9:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 0;
-      fish_pool[3] = 10;
-      fish_pool[4] = 0;
-      fish_pool[5] = 5;
-      fish_pool[6] = 10;
-      fish_pool[7] = 50;
-      break;
-    case 10:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 0;
-      fish_pool[3] = 0;
-      fish_pool[4] = 0;
-      fish_pool[5] = 0;
-      fish_pool[6] = 0;
-      fish_pool[7] = 75;
-      break;
-    default:
-      fish_pool[0] = 0;
-      fish_pool[1] = 0;
-      fish_pool[2] = 0;
-      fish_pool[3] = 0;
-      fish_pool[4] = 0;
-      fish_pool[5] = 0;
-      fish_pool[6] = 0;
-      fish_pool[7] = 75;
-      break;
+    return;
   }
+  fish_count++;
+  createFish(fishChoice(0, false), fish_count - 1);
 }
 
 /**
@@ -327,207 +865,297 @@ void MyASGEGame::fishPoolConstructor(int difficulty_progress)
 
 void MyASGEGame::createFish(int type, int target)
 {
+  const Tuning& tune = tuning->params;
   switch (type)
   {
     case STANDARD_FISH:
-      fishes[target].fish_size = CLOWNFISH_STANDARD_SIZE_MIN +
-                                 (std::rand() % (CLOWNFISH_STANDARD_SIZE_MAX -
-                                                 CLOWNFISH_STANDARD_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed =
-        STANDARD_SPEED_MIN +
-        (std::rand() % (STANDARD_SPEED_MAX - STANDARD_SPEED_MIN));
+      fishes[target].fish_size = roll(tune.standard_size);
+      fishes[target].speed = static_cast<float>(roll(tune.standard_speed));
       fishes[target].angle = 1;
-      fishes[target].x_negative = std::rand() % 2;
+      fishes[target].x_negative = nextRandom() % 2;
       fishes[target].y_negative = false;
       fishes[target].score_value = 1;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
       fishes[target].state_goal = 1000;
-      fishes[target].state_progress = 0;
       fishes[target].type = STANDARD_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::WHITE);
       break;
     case FAST_FISH:
-      fishes[target].fish_size =
-        CLOWNFISH_SMALL_SIZE_MIN +
-        (std::rand() % (CLOWNFISH_SMALL_SIZE_MAX - CLOWNFISH_SMALL_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed =
-        FAST_SPEED_MIN + (std::rand() % (FAST_SPEED_MAX - FAST_SPEED_MIN));
+      fishes[target].fish_size = roll(tune.small_size);
+      fishes[target].speed = static_cast<float>(roll(tune.fast_speed));
       fishes[target].angle = 1;
-      fishes[target].x_negative = std::rand() % 2;
+      fishes[target].x_negative = nextRandom() % 2;
       fishes[target].y_negative = false;
       fishes[target].score_value = 3;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
       fishes[target].state_goal = 1000;
-      fishes[target].state_progress = 0;
       fishes[target].type = FAST_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::WHITE);
       break;
     case ANGLED_FISH:
-      fishes[target].fish_size =
-        CLOWNFISH_SMALL_SIZE_MIN +
-        (std::rand() % (CLOWNFISH_SMALL_SIZE_MAX - CLOWNFISH_SMALL_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed =
-        STANDARD_SPEED_MIN +
-        (std::rand() % (STANDARD_SPEED_MAX - STANDARD_SPEED_MIN));
-      fishes[target].angle = (0.1 * (std::rand() % 7 + 1)) + 0.2;
-      fishes[target].x_negative = std::rand() % 2;
-      fishes[target].y_negative = std::rand() % 2;
+      fishes[target].fish_size = roll(tune.small_size);
+      fishes[target].speed = static_cast<float>(roll(tune.standard_speed));
+      fishes[target].angle = (0.1 * (nextRandom() % 7 + 1)) + 0.2;
+      fishes[target].x_negative = nextRandom() % 2;
+      fishes[target].y_negative = nextRandom() % 2;
       fishes[target].score_value = 3;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
       fishes[target].state_goal = 1000;
-      fishes[target].state_progress = 0;
       fishes[target].type = ANGLED_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::WHITE);
       break;
     case FAST_ANGLED_FISH:
-      fishes[target].fish_size =
-        CLOWNFISH_SMALL_SIZE_MIN +
-        (std::rand() % (CLOWNFISH_SMALL_SIZE_MAX - CLOWNFISH_SMALL_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed =
-        FAST_SPEED_MIN + (std::rand() % (FAST_SPEED_MAX - FAST_SPEED_MIN));
-      fishes[target].angle = 0.1 * (std::rand() % 9 + 1);
-      fishes[target].x_negative = std::rand() % 2;
-      fishes[target].y_negative = std::rand() % 2;
+      fishes[target].fish_size = roll(tune.small_size);
+      fishes[target].speed = static_cast<float>(roll(tune.fast_speed));
+      fishes[target].angle = 0.1 * (nextRandom() % 9 + 1);
+      fishes[target].x_negative = nextRandom() % 2;
+      fishes[target].y_negative = nextRandom() % 2;
       fishes[target].score_value = 5;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
-      fishes[target].state_goal = 500 + 100 * (std::rand() % 6);
-      fishes[target].state_progress = 0;
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].state_goal = 500 + 100 * (nextRandom() % 6);
       fishes[target].type = FAST_ANGLED_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::WHITE);
       break;
     case FASTER_FISH:
-      fishes[target].fish_size =
-        CLOWNFISH_SMALL_SIZE_MIN +
-        (std::rand() % (CLOWNFISH_SMALL_SIZE_MAX - CLOWNFISH_SMALL_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed =
-        FASTER_SPEED_MIN +
-        (std::rand() % (FASTER_SPEED_MAX - FASTER_SPEED_MIN));
+      fishes[target].fish_size = roll(tune.small_size);
+      fishes[target].speed = static_cast<float>(roll(tune.faster_speed));
       fishes[target].angle = 1;
-      fishes[target].x_negative = std::rand() % 2;
+      fishes[target].x_negative = nextRandom() % 2;
       fishes[target].y_negative = false;
       fishes[target].score_value = 5;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
       fishes[target].state_goal = 1000;
-      fishes[target].state_progress = 0;
       fishes[target].type = FASTER_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::WHITE);
       break;
     case SLIPPERY_FISH:
-      fishes[target].fish_size =
-        CLOWNFISH_TINY_SIZE_MIN +
-        (std::rand() % (CLOWNFISH_TINY_SIZE_MAX - CLOWNFISH_TINY_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed =
-        FAST_SPEED_MIN + (std::rand() % (FAST_SPEED_MAX - FAST_SPEED_MIN));
+      fishes[target].fish_size = roll(tune.tiny_size);
+      fishes[target].speed = static_cast<float>(roll(tune.fast_speed));
       fishes[target].angle = 1;
-      fishes[target].x_negative = std::rand() % 2;
+      fishes[target].x_negative = nextRandom() % 2;
       fishes[target].y_negative = false;
       fishes[target].score_value = 8;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
-      fishes[target].state_goal = 400 + 20 * (std::rand() % 11);
-      fishes[target].state_progress = 0;
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].state_goal = 400 + 20 * (nextRandom() % 11);
       fishes[target].type = SLIPPERY_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::WHITE);
       break;
     case TURNING_FISH:
-      fishes[target].fish_size =
-        CLOWNFISH_SMALL_SIZE_MIN +
-        (std::rand() % (CLOWNFISH_SMALL_SIZE_MAX - CLOWNFISH_SMALL_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed =
-        FASTER_SPEED_MIN +
-        (std::rand() % (FASTER_SPEED_MAX - FASTER_SPEED_MIN));
-      fishes[target].angle = 0.1 * (std::rand() % 9 + 1);
-      fishes[target].x_negative = std::rand() % 2;
-      fishes[target].y_negative = std::rand() % 2;
+      fishes[target].fish_size = roll(tune.small_size);
+      fishes[target].speed = static_cast<float>(roll(tune.faster_speed));
+      fishes[target].angle = 0.1 * (nextRandom() % 9 + 1);
+      fishes[target].x_negative = nextRandom() % 2;
+      fishes[target].y_negative = nextRandom() % 2;
       fishes[target].score_value = 8;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
-      fishes[target].state_goal = 250 + 50 * (std::rand() % 11);
-      fishes[target].state_progress = 0;
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].state_goal = 250 + 50 * (nextRandom() % 11);
       fishes[target].type = TURNING_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::WHITE);
       break;
     case ULTIMATE_FISH:
-      fishes[target].fish_size =
-        CLOWNFISH_TINY_SIZE_MIN +
-        (std::rand() % (CLOWNFISH_TINY_SIZE_MAX - CLOWNFISH_TINY_SIZE_MIN));
-      clownfish[target]->height(fishes[target].fish_size);
-      clownfish[target]->width(fishes[target].fish_size);
-      fishes[target].speed = FASTER_SPEED_MAX;
-      fishes[target].angle = 0.1 * (std::rand() % 9 + 1);
-      fishes[target].x_negative = std::rand() % 2;
-      fishes[target].y_negative = std::rand() % 2;
+      fishes[target].fish_size = roll(tune.tiny_size);
+      fishes[target].speed = static_cast<float>(tune.faster_speed.max);
+      fishes[target].angle = 0.1 * (nextRandom() % 9 + 1);
+      fishes[target].x_negative = nextRandom() % 2;
+      fishes[target].y_negative = nextRandom() % 2;
       fishes[target].score_value = 10;
-      fishes[target].xPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWX - fishes[target].fish_size);
-      fishes[target].yPos = (fishes[target].fish_size / 2) +
-                            std::rand() % (WINDOWY - fishes[target].fish_size);
-      fishes[target].state_goal = 100 + 100 * (std::rand() % 3);
-      fishes[target].state_progress = 0;
+      fishes[target].motion.origin_x =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWX - fishes[target].fish_size);
+      fishes[target].motion.origin_y =
+        (fishes[target].fish_size / 2) +
+        nextRandom() % (WINDOWY - fishes[target].fish_size);
+      fishes[target].state_goal = 100 + 100 * (nextRandom() % 3);
       fishes[target].type = ULTIMATE_FISH;
       fishFlipper(target);
-      clownfish[target]->colour(ASGE::COLOURS::CORAL);
       break;
     default:
       break;
   }
+  // clicks on the sprite of the fish this replaces no longer hit
+  fishes[target].spawn++;
+  fishes[target].sprite_dirty = true;
+  fishes[target].motion.start = sim_time;
+  aimFish(target);
+  scheduleAbility(target);
 }
 
 /**
- *   @brief   Sets the correct FlipFlag to the targeted Sprite
- *   @details Target Sprite replaces it's FlipFlag based off of the fishes
- * horizontal orientation
+ *   @brief   Starts a new motion segment from where the fish is now
+ *   @details Called after anything changes a fish's speed or heading.
+ *            The old segment still gives the position, as the fish
+ *            has been following it until now.
  */
 
-void MyASGEGame::fishFlipper(int target)
+void MyASGEGame::changeCourse(int target)
+{
+  FishMotion& motion = fishes[target].motion;
+  motion.origin_x = motion.x(sim_time, WINDOWX);
+  motion.origin_y = motion.y(sim_time, WINDOWY);
+  motion.start = sim_time;
+  aimFish(target);
+}
+
+/**
+ *   @brief   Sets a fish's velocity from its speed and heading
+ *   @details The angle splits the speed between the x and y axes, the
+ *            direction flags give the signs.
+ */
+
+void MyASGEGame::aimFish(int target)
+{
+  Clownfishes& fish = fishes[target];
+  fish.motion.velocity_x =
+    (fish.x_negative ? -fish.speed : fish.speed) * fish.angle;
+  fish.motion.velocity_y =
+    (fish.y_negative ? -fish.speed : fish.speed) * (1 - fish.angle);
+  fish.motion.size = static_cast<float>(fish.fish_size);
+  fish.motion.margin = fish.speed / 10;
+}
+
+/**
+ *   @brief   Registers when the target fish's next ability fires
+ *   @details Fish charge special_power_gain per second towards their
+ *            state_goal, so the fire time is known up front. Fish
+ *            without a special ability are never scheduled.
+ */
+
+void MyASGEGame::scheduleAbility(int target)
+{
+  if (TYPE_HAS_ABILITY[fishes[target].type])
+  {
+    ability_scheduler.schedule(
+      target,
+      sim_time +
+        static_cast<double>(fishes[target].state_goal) /
+          tuning->params.special_power_gain);
+  }
+  else
+  {
+    ability_scheduler.cancel(target);
+  }
+}
+
+/**
+ *   @brief   Moves the scheduled abilities to a new power gain
+ *   @details The charge a fish has built up is kept, what is left of
+ *            it is charged at the new gain, so a retuned gain shows at
+ *            once rather than from each fish's next ability.
+ *   @param   old_gain The special_power_gain the fire times were
+ *            scheduled with.
+ */
+
+void MyASGEGame::retimeAbilities(int old_gain)
 {
-  if (!fishes[target].x_negative)
+  int new_gain = tuning->params.special_power_gain;
+  if (old_gain != new_gain && old_gain > 0 && new_gain > 0)
   {
-    clownfish[target]->setFlipFlags(ASGE::Sprite::FlipFlags::FLIP_X);
+    ability_scheduler.rescale(sim_time,
+                              static_cast<double>(old_gain) / new_gain);
   }
-  if (fishes[target].x_negative)
+}
+
+/**
+ *   @brief   Marks the targeted Sprite's FlipFlag as out of date
+ *   @details The FlipFlag is set from the fish's horizontal orientation
+ *            by syncFishSprites, once the fish is on screen.
+ */
+
+void MyASGEGame::fishFlipper(int target)
+{
+  fishes[target].sprite_dirty = true;
+}
+
+/**
+ *   @brief   Culls off-screen fish and syncs the sprites of the rest
+ *   @details Fish drift up to speed/10 + fish_size outside the window
+ *            before wrapping. Those are flagged invisible and their
+ *            sprites are left alone. Visible fish only have their
+ *            position pushed when it moved, and size, colour and flip
+ *            only when the fish changed since the last push.
+ */
+
+void MyASGEGame::syncFishSprites()
+{
+  const Snapshot& snapshot = snapshots[front_snapshot];
+  FrameHistory::Fish* drawn = shown_frames.record(snapshot.fish_count);
+  visible_fish = 0;
+  culled_fish = 0;
+  for (int i = 0; i < snapshot.fish_count; i++)
   {
-    clownfish[target]->setFlipFlags(ASGE::Sprite::FlipFlags::NORMAL);
+    const FishView& fish = snapshot.fish[i];
+    SpriteState& state = sprite_state[i];
+    state.dirty = state.dirty || fish.dirty;
+    auto size = static_cast<float>(fish.size);
+    float x = fish.motion.x(snapshot.time, WINDOWX);
+    float y = fish.motion.y(snapshot.time, WINDOWY);
+    state.visible = x + size > 0 && x < WINDOWX && y + size > 0 && y < WINDOWY;
+    drawn[i].x = x;
+    drawn[i].y = y;
+    drawn[i].spawn = fish.spawn;
+    drawn[i].size = static_cast<std::uint16_t>(fish.size);
+    drawn[i].flipped_x = !fish.x_negative;
+    drawn[i].visible = state.visible;
+    if (!state.visible)
+    {
+      culled_fish++;
+      continue;
+    }
+    visible_fish++;
+
+    ASGE::Sprite* sprite = clownfish[i];
+    if (state.dirty)
+    {
+      sprite->width(size);
+      sprite->height(size);
+      sprite->colour(fish.type == ULTIMATE_FISH ? ASGE::COLOURS::CORAL
+                                                : ASGE::COLOURS::WHITE);
+      sprite->setFlipFlags(fish.x_negative ? ASGE::Sprite::FlipFlags::NORMAL
+                                           : ASGE::Sprite::FlipFlags::FLIP_X);
+      state.dirty = false;
+    }
+    if (state.x != x || state.y != y)
+    {
+      sprite->xPos(x);
+      sprite->yPos(y);
+      state.x = x;
+      state.y = y;
+    }
   }
 }
 
@@ -541,12 +1169,14 @@ void MyASGEGame::fishFlipper(int target)
 
 bool MyASGEGame::initBackground()
 {
+  TRACE_SCOPE("initBackground", "init");
   // load the background sprite
-  background = renderer->createRawSprite();
+  background = sprites.create(*renderer);
 
-  if (!background->loadTexture("/data/images/background.jpg"))
+  if (background == nullptr ||
+      !background->loadTexture("/data/images/background.jpg"))
   {
-    ASGE::DebugPrinter{} << "init::Failed to load background" << std::endl;
+    LOG_ERROR("init::Failed to load background");
     return false;
   }
 
@@ -557,12 +1187,13 @@ bool MyASGEGame::initBackground()
 
 bool MyASGEGame::initLifeBar()
 {
+  TRACE_SCOPE("initLifeBar", "init");
   // load the lifebar sprite
-  life_bar = renderer->createRawSprite();
+  life_bar = sprites.create(*renderer);
 
-  if (!life_bar->loadTexture("/data/images/lifebar.png"))
+  if (life_bar == nullptr || !life_bar->loadTexture("/data/images/lifebar.png"))
   {
-    ASGE::DebugPrinter{} << "init::Failed to load lifebar" << std::endl;
+    LOG_ERROR("init::Failed to load lifebar");
     return false;
   }
 
@@ -571,6 +1202,30 @@ bool MyASGEGame::initLifeBar()
   return true;
 }
 
+/**
+ *   @brief   Initialises the sprite shared by all particles
+ *   @details The life bar texture is a plain light square, which
+ *            takes the particle colours well when tinted.
+ *   @return  true if loaded, false if not
+ */
+
+bool MyASGEGame::initParticles()
+{
+  TRACE_SCOPE("initParticles", "init");
+  particle_sprite = sprites.create(*renderer);
+
+  if (particle_sprite == nullptr ||
+      !particle_sprite->loadTexture("/data/images/lifebar.png"))
+  {
+    LOG_ERROR("init::Failed to load particles");
+    return false;
+  }
+
+  particle_sprite->width(PARTICLE_SIZE);
+  particle_sprite->height(PARTICLE_SIZE);
+  return true;
+}
+
 /**
  *   @brief   Initialises the clownfish
  *   @details Attempts to load the clownfish used throughout the
@@ -581,14 +1236,27 @@ bool MyASGEGame::initLifeBar()
 
 bool MyASGEGame::initClownfish()
 {
+  TRACE_SCOPE("initClownfish", "init");
+  // the hit mask is shared by every fish, it only depends on the image
+  if (assets != nullptr)
+  {
+    hit_mask = &assets->fishMask();
+  }
+  else if (!fish_mask.load("/data/images/clown-fish-icon.png"))
+  {
+    LOG_WARN("init::Clownfish mask unavailable, using boxes");
+    fish_mask.fill(1, 1);
+  }
+
   // load the clownfish
   for (int i = 0; i < MAX_FISHCOUNT; i++)
   {
-    clownfish[i] = renderer->createRawSprite();
+    clownfish[i] = sprites.create(*renderer);
 
-    if (!clownfish[i]->loadTexture("/data/images/clown-fish-icon.png"))
+    if (clownfish[i] == nullptr ||
+        !clownfish[i]->loadTexture("/data/images/clown-fish-icon.png"))
     {
-      ASGE::DebugPrinter{} << "init::Failed to load clownfish" << std::endl;
+      LOG_ERROR("init::Failed to load clownfish");
       return false;
     }
 
@@ -596,6 +1264,8 @@ bool MyASGEGame::initClownfish()
     clownfish[i]->height(64);
     // clownfish[i]->setFlipFlags(ASGE::Sprite::FlipFlags::FLIP_X);
     clownfish[i]->yPos(50);
+    sprite_state[i].x = clownfish[i]->xPos();
+    sprite_state[i].y = clownfish[i]->yPos();
   }
   return true;
 }
@@ -623,11 +1293,12 @@ void MyASGEGame::setupResolution()
 }
 
 /**
- *   @brief   Processes any key inputs
+ *   @brief   Queues any key inputs
  *   @details This function is added as a callback to handle the game's
- *            keyboard input. For this game, calls to this function
- *            are thread safe, so you may alter the game's state as
- *            you see fit.
+ *            keyboard input. It only wakes the pacer and queues the
+ *            event for applyQueuedInput; it must not touch the game's
+ *            state, as the callback may run while the simulation
+ *            worker is writing the fish.
  *   @param   data The event data relating to key input.
  *   @see     KeyEvent
  *   @return  void
@@ -635,11 +1306,42 @@ void MyASGEGame::setupResolution()
 
 void MyASGEGame::keyHandler(ASGE::SharedEventData data)
 {
-  auto key = static_cast<const ASGE::KeyEvent*>(data.get());
+  TRACE_SCOPE("keyHandler", "input");
+  ALLOC_PHASE(INPUT);
+  frame_pacer.wake();
+  queued_input.push_back(
+    { ASGE::E_KEY, std::move(data), FrameHistory::Clock::now(), -1 });
+}
+
+/**
+ *   @brief   Handles a key event queued by keyHandler
+ *   @details Runs from update while the simulation worker is idle.
+ */
+
+void MyASGEGame::applyKey(const ASGE::KeyEvent* key)
+{
+  TRACE_SCOPE("applyKey", "input");
   if (key->key == ASGE::KEYS::KEY_Q && key->action == ASGE::KEYS::KEY_PRESSED)
   {
     toggleFPS();
   }
+  if (key->key == ASGE::KEYS::KEY_T && key->action == ASGE::KEYS::KEY_PRESSED)
+  {
+    toggleTrace();
+  }
+  if (key->key == ASGE::KEYS::KEY_B && key->action == ASGE::KEYS::KEY_PRESSED)
+  {
+    schooling = !schooling;
+    if (!schooling && !in_menu)
+    {
+      straightenFish();
+    }
+  }
+  if (key->key == ASGE::KEYS::KEY_A &&
+      key->action == ASGE::KEYS::KEY_PRESSED && in_menu)
+  {
+    attractMode(!attract_mode);
+  }
   if (key->key == ASGE::KEYS::KEY_RIGHT &&
       key->action == ASGE::KEYS::KEY_PRESSED)
   {
@@ -663,10 +1365,14 @@ void MyASGEGame::keyHandler(ASGE::SharedEventData data)
   if (key->key == ASGE::KEYS::KEY_ENTER &&
       key->action == ASGE::KEYS::KEY_RELEASED)
   {
-    if (menu_option == 2)
+    if (menu_option == MENU_EXIT)
     {
       signalExit();
     }
+    if (attract_mode && menu_option != MENU_EXIT)
+    {
+      gameStateInit();
+    }
     if (menu_option == 0)
     {
       in_menu = false;
@@ -678,6 +1384,15 @@ void MyASGEGame::keyHandler(ASGE::SharedEventData data)
       gamemode = 1;
       life = 1000;
     }
+    if (menu_option == MENU_ENDLESS)
+    {
+      in_menu = false;
+      gamemode = ENDLESS_GAMEMODE;
+    }
+    if (!in_menu)
+    {
+      telemetry.beginSession(gamemode);
+    }
   }
 
   if (key->key == ASGE::KEYS::KEY_ESCAPE &&
@@ -695,32 +1410,91 @@ void MyASGEGame::keyHandler(ASGE::SharedEventData data)
 }
 
 /**
- *   @brief   Processes any click inputs
+ *   @brief   Stamps the arrival of a click for latency tracking
+ *   @details Registered ahead of clickHandler, so this is the earliest
+ *            point the game can observe an input event.
+ *   @param   data The event data relating to mouse input.
+ *   @return  void
+ */
+
+void MyASGEGame::clickReceiptHandler(ASGE::SharedEventData data)
+{
+  TRACE_SCOPE("clickReceiptHandler", "input");
+  ALLOC_PHASE(INPUT);
+  auto click = static_cast<const ASGE::ClickEvent*>(data.get());
+  frame_pacer.wake();
+  // menu clicks are never dispatched, so they are not timed
+  if (click->action == ASGE::MOUSE::BUTTON_PRESSED &&
+      click->button == ASGE::MOUSE::MOUSE_BTN1 && !in_menu)
+  {
+    received_click = latency.clickReceived();
+  }
+}
+
+/**
+ *   @brief   Queues any click inputs
  *   @details This function is added as a callback to handle the game's
- *            mouse button input. For this game, calls to this function
- *            are thread safe, so you may alter the game's state as you
- *            see fit.
- *   @param   data The event data relating to key input.
+ *            mouse button input. It only queues the click, with when
+ *            it arrived and its latency ticket, for applyQueuedInput,
+ *            as the callback may run while the simulation worker is
+ *            writing the fish.
+ *   @param   data The event data relating to mouse input.
  *   @see     ClickEvent
  *   @return  void
  */
 
 void MyASGEGame::clickHandler(ASGE::SharedEventData data)
 {
-  auto click = static_cast<const ASGE::ClickEvent*>(data.get());
+  TRACE_SCOPE("clickHandler", "input");
+  ALLOC_PHASE(INPUT);
+  queued_input.push_back({ ASGE::E_MOUSE_CLICK,
+                           std::move(data),
+                           FrameHistory::Clock::now(),
+                           received_click });
+  received_click = -1;
+}
+
+/**
+ *   @brief   Handles a click queued by clickHandler
+ *   @details Runs from update while the simulation worker is idle. The
+ *            click is tested against the frame that was on screen when
+ *            it arrived, so a fast fish is hit where the player saw it
+ *            even if it has been drawn further on since. A fish only
+ *            counts while its slot still holds the fish that was drawn.
+ *   @param   at When clickHandler received the click.
+ *   @param   latency_ticket The click's latency ticket, or -1.
+ */
 
+void MyASGEGame::applyClick(const ASGE::ClickEvent* click,
+                            FrameHistory::Clock::time_point at,
+                            long latency_ticket)
+{
+  TRACE_SCOPE("applyClick", "input");
   double x_pos = click->xpos;
   double y_pos = click->ypos;
 
-  ASGE::DebugPrinter{} << "x_pos: " << x_pos << std::endl;
-  ASGE::DebugPrinter{} << "y_pos: " << y_pos << std::endl;
+  LOG_DEBUG_LIMITED(CLICK_LOGS_PER_SECOND, "click at {}, {}", x_pos, y_pos);
   if (click->action == ASGE::MOUSE::BUTTON_PRESSED &&
-      click->button == ASGE::MOUSE::MOUSE_BTN1)
+      click->button == ASGE::MOUSE::MOUSE_BTN1 && !in_menu)
   {
-    for (int i = 0; i < fish_count; i++)
+    latency.clickDispatched(latency_ticket);
+    int caught_fish = 0;
+    const FrameHistory::Frame* shown = shown_frames.shownAt(at);
+    int drawn_count = shown != nullptr ? shown->fish_count : 0;
+    for (int i = 0; i < drawn_count; i++)
     {
-      if (isInside(clownfish[i], x_pos, y_pos))
+      const FrameHistory::Fish& drawn = shown->fish[i];
+      if (drawn.visible && drawn.spawn == fishes[i].spawn &&
+          isInside(drawn, x_pos, y_pos))
       {
+        caught_fish++;
+        telemetry.caught(
+          fishes[i].type, fishes[i].score_value, drawn.x, drawn.y);
+        float half_size = static_cast<float>(drawn.size) / 2;
+        particles.emit(drawn.x + half_size,
+                       drawn.y + half_size,
+                       fishes[i].type == ULTIMATE_FISH ? ULTIMATE_CATCH_BURST
+                                                       : CATCH_BURST);
         score += fishes[i].score_value;
         if (gamemode == 1)
         {
@@ -731,11 +1505,49 @@ void MyASGEGame::clickHandler(ASGE::SharedEventData data)
           i);
       }
     }
+    telemetry.click(
+      static_cast<float>(x_pos), static_cast<float>(y_pos), caught_fish);
+    if (caught_fish == 0)
+    {
+      particles.emit(
+        static_cast<float>(x_pos), static_cast<float>(y_pos), MISS_BURST);
+    }
     if (gamemode == 1)
     {
       life -= 50;
     }
+    latency.clickApplied(latency_ticket);
+  }
+  else
+  {
+    // the game went back to the menu after the click arrived
+    latency.clickDropped(latency_ticket);
+  }
+}
+
+/**
+ *   @brief   Handles the input queued since the last frame
+ *   @details The callbacks only queue events, as they run while the
+ *            simulation worker may be writing the fish.
+ */
+
+void MyASGEGame::applyQueuedInput()
+{
+  ALLOC_PHASE(INPUT);
+  for (const auto& input : queued_input)
+  {
+    if (input.type == ASGE::E_KEY)
+    {
+      applyKey(static_cast<const ASGE::KeyEvent*>(input.data.get()));
+    }
+    else
+    {
+      applyClick(static_cast<const ASGE::ClickEvent*>(input.data.get()),
+                 input.at,
+                 input.latency_ticket);
+    }
   }
+  queued_input.clear();
 }
 
 /**
@@ -750,35 +1562,135 @@ void MyASGEGame::update(const ASGE::GameTime& game_time)
 {
   // auto dt_sec = game_time.delta.count() / 1000.0;;
   // make sure you use delta time in any movement calculations!
+  ALLOC_PHASE(UPDATE);
+
+  // the previous frame has been swapped by the time update runs
+  latency.framePresented();
+  shown_frames.presented(FrameHistory::Clock::now());
+
+  // nothing but menu_option changes in the menu, so it may idle
+  frame_pacer.allowIdle(in_menu && !attract_mode);
+  {
+    TRACE_SCOPE("pacerWait", "update");
+    frame_pacer.wait();
+  }
+  auto work_started = WorkClock::now();
+
+  TRACE_SCOPE("update", "update");
+  {
+    TRACE_SCOPE("simWait", "update");
+    sim_pipeline.wait();
+  }
+  AllocTracker::collect(sim_allocations);
+  // detail changes only while the worker is idle
+  school.neighbourLimit(governor.neighbourLimit());
+  particles.density(governor.particleDensity());
+  // the finished tick is drawn this frame, the next one is written to
+  // the snapshot that was drawn last frame
+  front_snapshot = 1 - front_snapshot;
+
+  // the worker is idle, so the game state is ours until the kick
+  applyQueuedInput();
+  growFish();
+
+  // a retuned set only ever changes between frames
+  int old_gain = tuning->params.special_power_gain;
+  if (tuning_watcher.poll(tuning, tuning_status))
+  {
+    LOG_INFO("{}", tuning_status);
+    retimeAbilities(old_gain);
+  }
 
   if (!in_menu)
   {
+    telemetry.frame(game_time.delta.count());
     if (gamemode == 1)
     {
-      life -= LIFE_LOSS * (game_time.delta.count() / 1000.0);
+      life -= tuning->params.life_loss *
+              (game_time.delta.count() / 1000.0);
 
       if (life > 1000)
         life = 1000;
+      telemetry.life(life);
 
       life_bar->xPos(0 - (WINDOWX * ((1000.0 - life) / 1000.0)));
       if (life <= 0)
         backToMenu();
     }
-    for (int i = 0; i < fish_count; i++)
+  }
+
+  sim_delta = game_time.delta.count() / 1000.0;
+  sim_pipeline.kick();
+
+  TRACE_SCOPE("particles", "update");
+  particles.update(static_cast<float>(game_time.delta.count() / 1000.0));
+  update_work_ms = Millis(WorkClock::now() - work_started).count();
+}
+
+/**
+ *   @brief   Simulates the fish for one tick
+ *   @details Runs on the simulation worker between the kick and the
+ *            wait in update, then publishes the result to the snapshot
+ *            render is not reading.
+ */
+
+void MyASGEGame::simulate()
+{
+  TRACE_SCOPE("simulate", "simulate");
+  ALLOC_PHASE(UPDATE);
+  if (!in_menu || attract_mode)
+  {
+    sim_time += sim_delta;
     {
-      fishes[i].state_progress +=
-        SPECIAL_POWER_GAIN * (game_time.delta.count() / 1000.0);
-      if (fishes[i].state_goal <= fishes[i].state_progress)
-      {
-        fishes[i].state_progress = 0;
-        fishSpecialAbility(fishes[i].type, i);
-      }
+      TRACE_SCOPE("abilities", "simulate");
+      ability_scheduler.runDue(sim_time, [this](int id) {
+        fishSpecialAbility(fishes[id].type, id);
+        scheduleAbility(id);
+      });
+    }
 
-      updateFishLocation(game_time, i);
+    if (schooling || in_menu)
+    {
+      TRACE_SCOPE("steerSchool", "simulate");
+      steerSchool(static_cast<float>(sim_delta));
     }
   }
+  publishSnapshot();
+  // the worker's counts belong to the frame that waits for this tick
+  AllocTracker::handOff(sim_allocations);
+}
+
+/**
+ *   @brief   Copies what render needs of the fish into the back snapshot
+ *   @details Pending sprite changes move into the snapshot with the
+ *            fish, so each is pushed to the sprite exactly once.
+ */
+
+void MyASGEGame::publishSnapshot()
+{
+  Snapshot& snapshot = snapshots[1 - front_snapshot];
+  snapshot.fish_count = fish_count;
+  snapshot.time = sim_time;
+  snapshot.neighbour_checks = school.neighbourChecks();
+  for (int i = 0; i < fish_count; i++)
+  {
+    Clownfishes& fish = fishes[i];
+    FishView& view = snapshot.fish[i];
+    view.motion = fish.motion;
+    view.size = fish.fish_size;
+    view.type = fish.type;
+    view.spawn = fish.spawn;
+    view.x_negative = fish.x_negative;
+    view.dirty = fish.sprite_dirty;
+    fish.sprite_dirty = false;
+  }
 }
 
+const char* const MyASGEGame::ABILITY_TRACE_NAMES[FISH_TYPE_COUNT] = {
+  "standardAbility", "fastAbility",     "angledAbility",   "fastAngledAbility",
+  "fasterAbility",   "slipperyAbility", "turningAbility",  "ultimateAbility"
+};
+
 /**
  *   @brief   Triggers a special ability for the fish that triggers this
  *   @details Depending on the type of fish it fires an "ability" that changes
@@ -787,6 +1699,8 @@ void MyASGEGame::update(const ASGE::GameTime& game_time)
 
 void MyASGEGame::fishSpecialAbility(int type, int id)
 {
+  TRACE_SCOPE(ABILITY_TRACE_NAMES[type], "ability");
+  const Tuning& tune = tuning->params;
   switch (type)
   {
     case FAST_ANGLED_FISH:
@@ -795,27 +1709,25 @@ void MyASGEGame::fishSpecialAbility(int type, int id)
     case SLIPPERY_FISH:
       if (fishes[id].state_goal >= 400)
       {
-        fishes[id].speed = FASTER_SPEED_MAX;
-        fishes[id].state_goal = 200 + 10 * (std::rand() % 11);
+        fishes[id].speed = static_cast<float>(tune.faster_speed.max);
+        fishes[id].state_goal = 200 + 10 * (nextRandom() % 11);
       }
       else
       {
-        fishes[id].speed =
-          FAST_SPEED_MIN + (std::rand() % (FAST_SPEED_MAX - FAST_SPEED_MIN));
-        ;
-        fishes[id].state_goal = 400 + 20 * (std::rand() % 11);
+        fishes[id].speed = static_cast<float>(roll(tune.fast_speed));
+        fishes[id].state_goal = 400 + 20 * (nextRandom() % 11);
       }
       break;
     case TURNING_FISH:
       fishes[id].x_negative = !fishes[id].x_negative;
       fishFlipper(id);
-      fishes[id].y_negative = std::rand() % 2;
-      fishes[id].angle = 0.1 * (std::rand() % 9 + 1);
-      fishes[id].state_goal = 250 + 50 * (std::rand() % 11);
+      fishes[id].y_negative = nextRandom() % 2;
+      fishes[id].angle = 0.1 * (nextRandom() % 9 + 1);
+      fishes[id].state_goal = 250 + 50 * (nextRandom() % 11);
       break;
     case ULTIMATE_FISH:
-      fishes[id].state_goal = 100 + 100 * (std::rand() % 3);
-      switch (std::rand() % 6)
+      fishes[id].state_goal = 100 + 100 * (nextRandom() % 3);
+      switch (nextRandom() % 6)
       {
         case 0:
           fishes[id].x_negative = !fishes[id].x_negative;
@@ -825,11 +1737,11 @@ void MyASGEGame::fishSpecialAbility(int type, int id)
           fishes[id].y_negative = !fishes[id].y_negative;
           break;
         case 2:
-          fishes[id].y_negative = std::rand() % 2;
-          fishes[id].angle = 0.1 * (std::rand() % 9 + 1);
+          fishes[id].y_negative = nextRandom() % 2;
+          fishes[id].angle = 0.1 * (nextRandom() % 9 + 1);
           break;
         case 3:
-          if (fishes[id].speed <= FASTER_SPEED_MAX)
+          if (fishes[id].speed <= static_cast<float>(tune.faster_speed.max))
           {
             fishes[id].speed += 200;
           }
@@ -843,65 +1755,72 @@ void MyASGEGame::fishSpecialAbility(int type, int id)
           break;
       }
       break;
-
     default:
-      // no special ability
+      // the other types have no ability
       break;
   }
+  changeCourse(id);
 }
 
 /**
- *   @brief   Updates the target fish's location
- *   @details Checks the direction of the fish then updates it's
- *            x and y locations based on their speed and angle.
+ *   @brief   Steers the fish as a school
+ *   @details Converts each fish's direction flags and angle into a
+ *            heading, lets the FishSchool steer them, then maps the
+ *            headings back. Speeds are left alone, so every type keeps
+ *            its pace, and abilities still change direction on top.
  */
 
-void MyASGEGame::updateFishLocation(const ASGE::GameTime& game_time, int target)
+void MyASGEGame::steerSchool(float delta_seconds)
 {
-  float x_pos = fishes[target].xPos;
-  float y_pos = fishes[target].yPos;
-  if (fishes[target].x_negative)
-  {
-    x_pos -= fishes[target].speed * (game_time.delta.count() / 1000.0) *
-             fishes[target].angle;
-    if (x_pos < -fishes[target].fish_size)
-    {
-      x_pos = (fishes[target].speed / 10) + WINDOWX;
-    }
-  }
-  else
+  FishSchool::Boid* boids = school.boids();
+  for (int i = 0; i < fish_count; i++)
   {
-    x_pos += fishes[target].speed * (game_time.delta.count() / 1000.0) *
-             fishes[target].angle;
-    if (x_pos > WINDOWX)
-    {
-      x_pos = -(fishes[target].speed / 10) - fishes[target].fish_size;
-    }
+    const Clownfishes& fish = fishes[i];
+    float half_size = static_cast<float>(fish.fish_size) / 2;
+    boids[i].x = fish.motion.x(sim_time, WINDOWX) + half_size;
+    boids[i].y = fish.motion.y(sim_time, WINDOWY) + half_size;
+    float heading_x = fish.x_negative ? -fish.angle : fish.angle;
+    float heading_y = fish.y_negative ? fish.angle - 1 : 1 - fish.angle;
+    float length = std::sqrt(heading_x * heading_x + heading_y * heading_y);
+    boids[i].heading_x = heading_x / length;
+    boids[i].heading_y = heading_y / length;
   }
 
-  if (fishes[target].y_negative)
+  school.steer(fish_count, delta_seconds);
+
+  for (int i = 0; i < fish_count; i++)
   {
-    y_pos -= fishes[target].speed * (game_time.delta.count() / 1000.0) *
-             (1 - fishes[target].angle);
-    if (y_pos < -fishes[target].fish_size)
+    float along_x = std::fabs(boids[i].heading_x);
+    float along_y = std::fabs(boids[i].heading_y);
+    fishes[i].angle = along_x / (along_x + along_y);
+    fishes[i].y_negative = boids[i].heading_y < 0;
+    bool x_negative = boids[i].heading_x < 0;
+    if (x_negative != fishes[i].x_negative)
     {
-      y_pos = (fishes[target].speed / 10) + WINDOWY;
+      fishes[i].x_negative = x_negative;
+      fishFlipper(i);
     }
+    changeCourse(i);
   }
-  else
+}
+
+/**
+ *   @brief   Puts the straight swimming types back on their course
+ *   @details Steering leaves them at an angle, which they would keep
+ *            once schooling stops as no ability turns them back.
+ */
+
+void MyASGEGame::straightenFish()
+{
+  for (int i = 0; i < fish_count; i++)
   {
-    y_pos += fishes[target].speed * (game_time.delta.count() / 1000.0) *
-             (1 - fishes[target].angle);
-    if (y_pos > WINDOWY)
+    if (TYPE_HORIZONTAL[fishes[i].type])
     {
-      y_pos = -(fishes[target].speed / 10) - fishes[target].fish_size;
+      fishes[i].angle = 1;
+      fishes[i].y_negative = false;
+      changeCourse(i);
     }
   }
-
-  fishes[target].xPos = x_pos;
-  fishes[target].yPos = y_pos;
-  clownfish[target]->xPos(x_pos);
-  clownfish[target]->yPos(y_pos);
 }
 
 /**
@@ -912,12 +1831,26 @@ void MyASGEGame::updateFishLocation(const ASGE::GameTime& game_time, int target)
  *   @return  void
  */
 
-void MyASGEGame::render(const ASGE::GameTime&)
+void MyASGEGame::render(const ASGE::GameTime& game_time)
 {
+  TRACE_SCOPE("render", "render");
+  ALLOC_PHASE(RENDER);
+  auto work_started = WorkClock::now();
   renderer->setFont(0);
   renderer->renderSprite(*background);
   if (in_menu)
   {
+    if (attract_mode)
+    {
+      syncFishSprites();
+      for (int i = 0; i < snapshots[front_snapshot].fish_count; i++)
+      {
+        if (sprite_state[i].visible)
+        {
+          renderer->renderSprite(*clownfish[i]);
+        }
+      }
+    }
     renderer->renderText(welcome,
                          WINDOWX / 2 - (welcome.length() * AVERAGE_FONT_LENGTH),
                          WINDOWY / 2 - DISTANCE_BETWEEN_CHOICES,
@@ -931,9 +1864,9 @@ void MyASGEGame::render(const ASGE::GameTime&)
                          1.0,
                          ASGE::COLOURS::DARKORANGE);
 
-    renderer->renderText(menu_option == 2 ? ">Exit" : "Exit",
-                         menu_option == 2 ? menuLocationX(3, 5)
-                                          : menuLocationX(3, 4),
+    renderer->renderText(menu_option == MENU_EXIT ? ">Exit" : "Exit",
+                         menu_option == MENU_EXIT ? menuLocationX(4, 5)
+                                                  : menuLocationX(4, 4),
                          WINDOWY / 2 + DISTANCE_BETWEEN_CHOICES,
                          1.0,
                          ASGE::COLOURS::DARKORANGE);
@@ -944,13 +1877,32 @@ void MyASGEGame::render(const ASGE::GameTime&)
                          WINDOWY / 2 + DISTANCE_BETWEEN_CHOICES,
                          1.0,
                          ASGE::COLOURS::DARKORANGE);
+
+    renderer->renderText(menu_option == MENU_ENDLESS ? ">Endless"
+                                                     : "Endless",
+                         menu_option == MENU_ENDLESS ? menuLocationX(3, 8)
+                                                     : menuLocationX(3, 7),
+                         WINDOWY / 2 + DISTANCE_BETWEEN_CHOICES,
+                         1.0,
+                         ASGE::COLOURS::DARKORANGE);
   }
   else
   {
     renderer->renderSprite(*life_bar);
-    for (int i = 0; i < fish_count; i++)
     {
-      renderer->renderSprite(*clownfish[i]);
+      TRACE_SCOPE("drawFish", "render");
+      syncFishSprites();
+      for (int i = 0; i < snapshots[front_snapshot].fish_count; i++)
+      {
+        if (sprite_state[i].visible)
+        {
+          renderer->renderSprite(*clownfish[i]);
+        }
+      }
+    }
+    {
+      TRACE_SCOPE("drawParticles", "render");
+      particles.render(*renderer, *particle_sprite);
     }
     renderer->renderText(score_fluff + std::to_string(score),
                          WINDOWX - (AVERAGE_FONT_LENGTH * 24),
@@ -958,94 +1910,205 @@ void MyASGEGame::render(const ASGE::GameTime&)
                          1.0,
                          ASGE::COLOURS::DARKORANGE);
   }
+  renderHud();
+  publishLiveState(game_time.delta.count());
+  governor.frame(update_work_ms,
+                 Millis(WorkClock::now() - work_started).count());
+  latency.frameRendered();
+  // a recorded frame allocates its records, it is no gameplay frame
+  allocations.endFrame(!in_menu && (headless_renderer == nullptr ||
+                                    !headless_renderer->recordingDraws()));
+}
+
+/**
+ *   @brief   Writes this frame's state for external monitors
+ *   @details Fish are exported as they were just drawn. Menus without
+ *            the attract school draw none.
+ *   @param   frame_ms The length of the frame.
+ */
+
+void MyASGEGame::publishLiveState(double frame_ms)
+{
+  StateExportBlock* block = live_state.beginWrite(frame_ms);
+  if (block == nullptr)
+  {
+    return;
+  }
+  const Snapshot& snapshot = snapshots[front_snapshot];
+  int drawn = in_menu && !attract_mode ? 0 : snapshot.fish_count;
+  drawn = drawn < STATE_EXPORT_MAX_FISH ? drawn : STATE_EXPORT_MAX_FISH;
+  block->score = score;
+  block->life = life;
+  block->difficulty_state = difficulty_state;
+  block->game_mode = gamemode;
+  block->in_menu = in_menu ? 1 : 0;
+  block->fish_count = drawn;
+  for (int i = 0; i < drawn; i++)
+  {
+    StateExportFish& fish = block->fish[i];
+    fish.x = static_cast<std::int16_t>(sprite_state[i].x);
+    fish.y = static_cast<std::int16_t>(sprite_state[i].y);
+    fish.size = static_cast<std::uint16_t>(snapshot.fish[i].size);
+    fish.type = static_cast<std::uint8_t>(snapshot.fish[i].type);
+    fish.visible = sprite_state[i].visible ? 1 : 0;
+  }
+  live_state.endWrite();
+}
+
+/**
+ *   @brief   Renders the debug HUD
+ *   @details Shares the FPS toggle, so the performance figures are
+ *            shown and hidden together.
+ *   @return  void
+ */
+
+void MyASGEGame::renderHud()
+{
+  TRACE_SCOPE("renderHud", "render");
+  if (!show_fps)
+  {
+    return;
+  }
+  renderer->renderText(latency.hudText(),
+                       HUD_X_LOCATION,
+                       WINDOWY - HUD_Y_OFFSET,
+                       0.5,
+                       ASGE::COLOURS::WHITE);
+  renderer->renderText(frame_pacer.idling() ? "Pacing: menu idle"
+                                            : "Pacing: active",
+                       HUD_X_LOCATION,
+                       WINDOWY - HUD_Y_OFFSET - HUD_LINE_HEIGHT,
+                       0.5,
+                       ASGE::COLOURS::WHITE);
+  char fish_line[64];
+  std::snprintf(fish_line,
+                sizeof(fish_line),
+                "Fish: %d visible, %d culled",
+                visible_fish,
+                culled_fish);
+  renderer->renderText(fish_line,
+                       HUD_X_LOCATION,
+                       WINDOWY - HUD_Y_OFFSET - 2 * HUD_LINE_HEIGHT,
+                       0.5,
+                       ASGE::COLOURS::WHITE);
+  char particle_line[64];
+  std::snprintf(particle_line,
+                sizeof(particle_line),
+                "Particles: %d live, %.0fus update",
+                particles.liveCount(),
+                particles.updateMicros());
+  renderer->renderText(particle_line,
+                       HUD_X_LOCATION,
+                       WINDOWY - HUD_Y_OFFSET - 3 * HUD_LINE_HEIGHT,
+                       0.5,
+                       ASGE::COLOURS::WHITE);
+  renderer->renderText(memory.hudText(),
+                       HUD_X_LOCATION,
+                       WINDOWY - HUD_Y_OFFSET - 4 * HUD_LINE_HEIGHT,
+                       0.5,
+                       ASGE::COLOURS::WHITE);
+  renderer->renderText(tuning_status,
+                       HUD_X_LOCATION,
+                       WINDOWY - HUD_Y_OFFSET - 5 * HUD_LINE_HEIGHT,
+                       0.5,
+                       ASGE::COLOURS::WHITE);
+  if (schooling || (in_menu && attract_mode))
+  {
+    char line[64];
+    std::snprintf(line,
+                  sizeof(line),
+                  "School: %d fish, %ld neighbour checks",
+                  snapshots[front_snapshot].fish_count,
+                  snapshots[front_snapshot].neighbour_checks);
+    renderer->renderText(line,
+                         HUD_X_LOCATION,
+                         WINDOWY - HUD_Y_OFFSET - 6 * HUD_LINE_HEIGHT,
+                         0.5,
+                         ASGE::COLOURS::WHITE);
+  }
+  if (AllocTracker::instrumented())
+  {
+    renderer->renderText(allocations.hudText(),
+                         HUD_X_LOCATION,
+                         WINDOWY - HUD_Y_OFFSET - 7 * HUD_LINE_HEIGHT,
+                         0.5,
+                         ASGE::COLOURS::WHITE);
+  }
+  renderer->renderText(governor.hudText(),
+                       HUD_X_LOCATION,
+                       WINDOWY - HUD_Y_OFFSET - 8 * HUD_LINE_HEIGHT,
+                       0.5,
+                       ASGE::COLOURS::WHITE);
 }
 
 /**
- *   @brief   Collision checks a point and an AABB
+ *   @brief   Collision checks a point and a fish as it was drawn
  *   @details Designed to check if a point resides inside an
- *            AABB. It uses the sprite to form the rectangle
- *            and the x,y floats to establish the point.
- *   @param   sprite, the sprite to check against
+ *            AABB formed from the fish, then, only for points that
+ *            do, whether it lands on a solid pixel of the fish mask.
+ *            The box is half open, so neighbouring sprites never both
+ *            claim a point on their shared edge. Sampling scales the
+ *            point by the drawn size and mirrors it for FLIP_X.
+ *   @param   fish, the fish as a frame drew it
  *   @param   mouse_x, the x position of the point
  *   @param   mouse_y, the y position of the point
- *   @return  void
+ *   @return  true if the point is on the fish
  */
 
-bool MyASGEGame::isInside(const ASGE::Sprite* sprite,
+bool MyASGEGame::isInside(const FrameHistory::Fish& fish,
                           float mouse_x,
                           float mouse_y) const
 {
-  bool x_truth = false;
-  bool y_truth = false;
-  if (sprite->xPos() < mouse_x && mouse_x < sprite->xPos() + sprite->width())
-    x_truth = true;
-  if (sprite->yPos() < mouse_y && mouse_y < sprite->yPos() + sprite->height())
-    y_truth = true;
-  if (x_truth && y_truth)
-    return true;
-  else
+  auto size = static_cast<float>(fish.size);
+  float local_x = mouse_x - fish.x;
+  float local_y = mouse_y - fish.y;
+  if (local_x < 0 || local_x >= size || local_y < 0 || local_y >= size)
+  {
     return false;
+  }
+  return hit_mask->contains(local_x / size, local_y / size, fish.flipped_x);
 }
 
 /**
  *   @brief   Gives menu x values based on the text
  *            length it's given
- *   @details Travis doesnt like a constant if statement,
- *            so I just commented it out in case I expand
- *            the menu again. Laziness, eh? ¯\_(ツ)_/¯
+ *   @details The choices are spaced DISTANCE_BETWEEN_CHOICES apart
+ *            and centred on the window, whether there is an odd or
+ *            an even number of them.
  *   @return  int
  */
 
 int MyASGEGame::menuLocationX(int menu_order, int text_length)
 {
-  /*if (MENU_MAX % 2 == 1)
-  {
-    if (menu_order > MENU_MAX + 1 / 2)
-    {
-      return WINDOWX / 2 +
-             ((menu_order - ((MENU_MAX + 1) / 2)) * DISTANCE_BETWEEN_CHOICES) -
-             (AVERAGE_FONT_LENGTH * text_length);
-    }
-    else
-    {
-      return WINDOWX / 2 -
-             ((MENU_MAX + 3 / 2) - menu_order * DISTANCE_BETWEEN_CHOICES) -
-             (AVERAGE_FONT_LENGTH * text_length);
-    }
-  }
-  else
-  {
-    if (menu_order > (MENU_MAX + 2) / 2)
-    {
-      return WINDOWX / 2 +
-             ((menu_order - ((MENU_MAX + 2) / 2)) * DISTANCE_BETWEEN_CHOICES) -
-             (AVERAGE_FONT_LENGTH * text_length);
-    }
-    if (menu_order < (MENU_MAX + 2) / 2)
-    {
-      return WINDOWX / 2 -
-             ((((MENU_MAX + 2) / 2) - menu_order) * DISTANCE_BETWEEN_CHOICES) -
-             (AVERAGE_FONT_LENGTH * text_length);
-    }
-    return WINDOWX / 2 - (AVERAGE_FONT_LENGTH * text_length);
-  }*/
-  if (menu_order > (MENU_MAX + 2) / 2)
-  {
-    return WINDOWX / 2 +
-           ((menu_order - ((MENU_MAX + 2) / 2)) * DISTANCE_BETWEEN_CHOICES) -
-           (AVERAGE_FONT_LENGTH * text_length);
-  }
-  if (menu_order < (MENU_MAX + 2) / 2)
-  {
-    return WINDOWX / 2 -
-           ((((MENU_MAX + 2) / 2) - menu_order) * DISTANCE_BETWEEN_CHOICES) -
-           (AVERAGE_FONT_LENGTH * text_length);
-  }
-  return WINDOWX / 2 - (AVERAGE_FONT_LENGTH * text_length);
+  return WINDOWX / 2 +
+         ((2 * menu_order - (MENU_MAX + 2)) * DISTANCE_BETWEEN_CHOICES) / 2 -
+         (AVERAGE_FONT_LENGTH * text_length);
 }
 
 void MyASGEGame::backToMenu()
 {
+  telemetry.endSession(score, difficulty_state);
   in_menu = true;
+  particles.clear();
   gameStateInit();
-}
\ No newline at end of file
+  if (attract_mode)
+  {
+    attractInit();
+  }
+}
+/**
+ *   @brief   Starts or stops a trace capture
+ *   @details Stopping writes the capture as Chrome trace JSON to the
+ *            traces folder of the write directory.
+ */
+
+void MyASGEGame::toggleTrace()
+{
+  if (!TraceRecorder::enabled())
+  {
+    TraceRecorder::start();
+    LOG_INFO("Trace capture started");
+    return;
+  }
+  LOG_INFO("Trace written to {}", TraceRecorder::stop());
+}
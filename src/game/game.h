@@ -1,25 +1,54 @@
 #pragma once
 #include <Engine/OGLGame.h>
+#include <random>
 #include <string>
+#include <vector>
+
+#include "ability_scheduler.h"
+#include "alloc_tracker.h"
+#include "asset_store.h"
+#include "fish_motion.h"
+#include "fish_school.h"
+#include "frame_governor.h"
+#include "frame_history.h"
+#include "frame_pacer.h"
+#include "hit_mask.h"
+#include "latency_tracker.h"
+#include "memory_ledger.h"
+#include "null_renderer.h"
+#include "particle_system.h"
+#include "sim_pipeline.h"
+#include "sprite_arena.h"
+#include "state_export.h"
+#include "telemetry_recorder.h"
+#include "tuning_watcher.h"
 
 /**
  *  An OpenGL Game based on ASGE.
  */
 enum
 {
-  MAX_FISHCOUNT = 20,
-  FISH_TYPE_COUNT = 8,
-  DIFFICULTY_BRACKET_COUNT = 10,
-  DIFFICULTY1 = 3,
-  DIFFICULTY2 = 10,
-  DIFFICULTY3 = 25,
-  DIFFICULTY4 = 60,
-  DIFFICULTY5 = 100,
-  DIFFICULTY6 = 200,
-  DIFFICULTY7 = 350,
-  DIFFICULTY8 = 500,
-  DIFFICULTY9 = 750,
-  DIFFICULTY10 = 1000
+  MAX_FISHCOUNT = 2048,
+  SCHOOL_FISHCOUNT = 2000
+};
+
+/**
+ *  The options a game is started with, as read from the command line.
+ *  A session host starts every session with the same set.
+ */
+struct GameOptions
+{
+  int target_fps = -1;         /**< Below zero keeps the default. */
+  double frame_budget_ms = -1; /**< Ditto, zero turns the governor off. */
+  long alloc_budget = -1;      /**< Below zero checks nothing. */
+  bool endless = false;
+  bool serial = false;
+  bool attract = false;
+  std::string tuning_file = "data/tuning.json";
+  std::string export_name; /**< Empty exports nothing. */
+  unsigned seed = 1;
+  bool seeded = false;
+  bool render_check = false; /**< Headless only, see checkRender. */
 };
 
 class MyASGEGame : public ASGE::OGLGame
@@ -31,31 +60,83 @@ class MyASGEGame : public ASGE::OGLGame
 
   bool init() override;
 
+  bool initHeadless();
+
+  void configure(const GameOptions& options);
+
+  bool runHeadless(int frames);
+
+  void stepHeadless(int frame, const ASGE::GameTime& game_time);
+
+  void shareAssets(const AssetStore* store);
+
+  void shareTelemetry(TelemetryWriter* writer);
+
+  void seed(unsigned value);
+
+  void retune(std::shared_ptr<const TuningSet> set);
+
+  void closeTelemetry();
+
+  int currentScore() const { return score; }
+
+  void allocationBudget(long allocations_per_frame);
+
+  bool withinAllocationBudget() const { return allocations.withinBudget(); }
+
+  const NullRenderer* headlessRenderer() const { return headless_renderer; }
+
+  void targetFPS(int fps);
+
+  void frameBudget(double frame_ms);
+
+  void endlessMode();
+
+  void attractMode(bool enabled);
+
+  void tuningFile(const std::string& path);
+
+  void pipelined(bool threaded);
+
+  bool exportLiveState(const std::string& name);
+
  private:
   void keyHandler(ASGE::SharedEventData data);
 
   void clickHandler(ASGE::SharedEventData data);
 
+  void clickReceiptHandler(ASGE::SharedEventData data);
+
+  void applyQueuedInput();
+
+  void applyKey(const ASGE::KeyEvent* key);
+
+  void applyClick(const ASGE::ClickEvent* click,
+                  FrameHistory::Clock::time_point at,
+                  long latency_ticket);
+
   void setupResolution();
 
+  bool initGame();
+
   void update(const ASGE::GameTime&) override;
 
   void render(const ASGE::GameTime&) override;
 
-  bool isInside(const ASGE::Sprite* sprite, float x, float y) const;
+  bool isInside(const FrameHistory::Fish& fish, float x, float y) const;
+
+  int nextRandom();
+
+  int roll(const TuningRange& range);
 
   int key_callback_id = -1;   /**< Key Input Callback ID. */
   int mouse_callback_id = -1; /**< Mouse Input Callback ID. */
+  int receipt_callback_id = -1; /**< Click Receipt Callback ID. */
   bool in_menu = true;
   int menu_option = 0;
   int fish_count = 0;
   int score = 0;
   int difficulty_state = 0;
-  int difficulty_limits[DIFFICULTY_BRACKET_COUNT] = {
-    DIFFICULTY1, DIFFICULTY2, DIFFICULTY3, DIFFICULTY4, DIFFICULTY5,
-    DIFFICULTY6, DIFFICULTY7, DIFFICULTY8, DIFFICULTY9, DIFFICULTY10
-  };
-  int fish_pool[FISH_TYPE_COUNT] = { 0 };
   int gamemode = 0;
   float life = 0;
   std::string welcome = "Would you like to start the game?";
@@ -64,39 +145,151 @@ class MyASGEGame : public ASGE::OGLGame
   class Clownfishes
   {
    public:
-    float xPos = 0;
-    float yPos = 0;
+    FishMotion motion;
     int fish_size = 32;
     float speed = 100;
     float angle = 1;
     bool y_negative = false;
     bool x_negative = false;
-    float state_progress = 0;
     int state_goal = 0;
     int score_value = 0;
     int type = 0;
+    bool sprite_dirty = true;  /**< Size, colour or flip not published. */
+    int spawn = 0;             /**< Counts the fish created in this slot. */
   };
   Clownfishes fishes[MAX_FISHCOUNT];
+
+  /**
+   *  What render needs of a fish, copied out at the end of a tick.
+   */
+  struct FishView
+  {
+    FishMotion motion;
+    int size = 0;
+    int type = 0;
+    int spawn = 0;
+    bool x_negative = false;
+    bool dirty = false;
+  };
+
+  /**
+   *  The fish as of the end of one tick. Render reads the front one
+   *  while the simulation worker writes the other.
+   */
+  struct Snapshot
+  {
+    int fish_count = 0;
+    double time = 0; /**< The game time the fish are drawn at. */
+    long neighbour_checks = 0;
+    FishView fish[MAX_FISHCOUNT];
+  };
+  Snapshot snapshots[2];
+  int front_snapshot = 0;
+
+  /**
+   *  What was last pushed to a fish sprite, owned by the main thread.
+   */
+  struct SpriteState
+  {
+    float x = 0;
+    float y = 0;
+    bool visible = false; /**< On screen as of the last sprite sync. */
+    bool dirty = true;    /**< Size, colour or flip not pushed yet. */
+  };
+  SpriteState sprite_state[MAX_FISHCOUNT];
+  FrameHistory shown_frames; /**< Clicks are resolved against these. */
+
+  struct QueuedInput
+  {
+    ASGE::EventType type;
+    ASGE::SharedEventData data;
+    FrameHistory::Clock::time_point at; /**< When the game received it. */
+    long latency_ticket;                /**< -1 when not timed. */
+  };
+  std::vector<QueuedInput> queued_input;
+  long received_click = -1; /**< Ticket of the click being delivered. */
+
+  void simulate();
+  void publishSnapshot();
+  double sim_delta = 0;
+  AllocTracker::Counts sim_allocations[AllocTracker::PHASE_COUNT];
+  bool sim_threaded = true;
+  void changeCourse(int target);
+  void aimFish(int target);
+  static const char* const ABILITY_TRACE_NAMES[FISH_TYPE_COUNT];
   void createFish(int type, int target);
   int fishChoice(int type_lost, bool chance_to_stay);
   void difficultyCalculation();
-  void fishPoolConstructor(int difficulty_progress);
+  int difficultyGate(int bracket) const;
+  int targetFishCount() const;
+  void growFish();
   void fishSpecialAbility(int type, int target);
+  void scheduleAbility(int target);
+  void retimeAbilities(int old_gain);
+  double sim_time = 0;
+  AbilityScheduler ability_scheduler;
   void fishFlipper(int target);
+  void syncFishSprites();
+  int visible_fish = 0;
+  int culled_fish = 0;
+  void attractInit();
+  void steerSchool(float delta_seconds);
+  void straightenFish();
+  bool attract_mode = false;
+  bool schooling = false;
+  FishSchool school;
 
-  // art assets for the game
+  // art assets for the game, owned by the sprite arena
+  SpriteArena sprites;
   bool initBackground();
   ASGE::Sprite* background = nullptr;
 
   bool initClownfish();
   ASGE::Sprite* clownfish[MAX_FISHCOUNT] = { nullptr };
+  HitMask fish_mask;
+  const HitMask* hit_mask = &fish_mask; /**< The store's when hosted. */
   // ASGE::Sprite *clownfish = nullptr;
 
   bool initLifeBar();
   ASGE::Sprite* life_bar = nullptr;
 
+  bool initParticles();
+  ASGE::Sprite* particle_sprite = nullptr;
+  ParticleSystem particles;
+
   void backToMenu();
-  void updateFishLocation(const ASGE::GameTime& game_time, int i);
+  void toggleTrace();
   int menuLocationX(int menu_order, int text_length);
   void gameStateInit();
+  void accountMemory();
+  MemoryLedger memory;
+
+  std::minstd_rand rng; /**< Per session, so hosted games differ. */
+  bool seeded = false;
+  const AssetStore* assets = nullptr;
+
+  std::shared_ptr<const TuningSet> tuning;
+  TuningWatcher tuning_watcher;
+  std::string tuning_file = "data/tuning.json";
+  std::string tuning_status;
+
+  LatencyTracker latency;
+  AllocTracker allocations;
+  bool alloc_budget_set = false;
+  TelemetryRecorder telemetry;
+  FramePacer frame_pacer;
+  FrameGovernor governor;
+  double update_work_ms = 0; /**< This frame's update, pacing excluded. */
+  NullRenderer* headless_renderer = nullptr;
+  bool render_check = false;
+  bool checkRender(const ASGE::GameTime& game_time);
+  void headlessBotInput(int frame);
+  std::shared_ptr<ASGE::KeyEvent> bot_enter;   /**< Reused every run. */
+  std::shared_ptr<ASGE::ClickEvent> bot_click; /**< Reused every click. */
+  void renderHud();
+  void publishLiveState(double frame_ms);
+  StateExport live_state;
+
+  // last, so the worker is joined before anything it touches goes
+  SimPipeline sim_pipeline;
 };
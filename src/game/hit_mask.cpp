@@ -0,0 +1,139 @@
+#include <Engine/FileIO.h>
+
+#include "hit_mask.h"
+
+// stb_image is built into the engine, only its C entry points are used
+extern "C"
+{
+  unsigned char* stbi_load_from_memory(const unsigned char* buffer,
+                                       int length,
+                                       int* width,
+                                       int* height,
+                                       int* channels_in_file,
+                                       int desired_channels);
+  void stbi_image_free(void* pixels);
+}
+
+/**
+ *   @brief   Builds the mask from the alpha channel of an image
+ *   @details Reads the image through the engine's file system and
+ *            decodes it to RGBA. Images without alpha come out fully
+ *            solid, so they behave like a plain box.
+ *   @param   file_path The image, as passed to Sprite::loadTexture.
+ *   @return  true if the image was decoded.
+ */
+
+bool HitMask::load(const std::string& file_path)
+{
+  ASGE::FILEIO::File file;
+  if (!file.open(file_path))
+  {
+    return false;
+  }
+  ASGE::FILEIO::IOBuffer buffer = file.read();
+  file.close();
+  if (buffer.length == 0)
+  {
+    return false;
+  }
+
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+  unsigned char* pixels =
+    stbi_load_from_memory(buffer.as_unsigned_char(),
+                          static_cast<int>(buffer.length),
+                          &width,
+                          &height,
+                          &channels,
+                          4);
+  if (pixels == nullptr)
+  {
+    return false;
+  }
+
+  resize(width, height);
+  for (int y = 0; y < height; y++)
+  {
+    const unsigned char* row = pixels + static_cast<size_t>(y * width) * 4;
+    for (int x = 0; x < width; x++)
+    {
+      if (row[x * 4 + 3] >= ALPHA_THRESHOLD)
+      {
+        set(x, y);
+      }
+    }
+  }
+  stbi_image_free(pixels);
+  return true;
+}
+
+/**
+ *   @brief   Makes every pixel solid
+ *   @details The fallback when an image can not be read, hit tests
+ *            then match the sprite's box.
+ */
+
+void HitMask::fill(int width, int height)
+{
+  resize(width, height);
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      set(x, y);
+    }
+  }
+}
+
+/**
+ *   @brief   Tests a point against the mask
+ *   @param   u The point's x across the sprite, in [0, 1).
+ *   @param   v The point's y down the sprite, in [0, 1).
+ *   @param   flipped_x Whether the sprite draws the texture mirrored.
+ *   @return  true if the point falls on a solid pixel.
+ */
+
+bool HitMask::contains(float u, float v, bool flipped_x) const
+{
+  auto x = static_cast<int>(u * static_cast<float>(mask_width));
+  auto y = static_cast<int>(v * static_cast<float>(mask_height));
+  if (x < 0 || y < 0 || x >= mask_width || y >= mask_height)
+  {
+    return false;
+  }
+  if (flipped_x)
+  {
+    x = mask_width - 1 - x;
+  }
+  std::uint64_t word =
+    rows[static_cast<size_t>(y * words_per_row + x / 64)];
+  return ((word >> (x % 64)) & 1u) != 0;
+}
+
+int HitMask::solidPixels() const
+{
+  int count = 0;
+  for (auto word : rows)
+  {
+    for (; word != 0; word &= word - 1)
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+void HitMask::resize(int width, int height)
+{
+  mask_width = width;
+  mask_height = height;
+  words_per_row = (width + 63) / 64;
+  rows.assign(static_cast<size_t>(words_per_row * height), 0);
+}
+
+void HitMask::set(int x, int y)
+{
+  rows[static_cast<size_t>(y * words_per_row + x / 64)] |=
+    std::uint64_t(1) << (x % 64);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  A one bit per pixel collision mask built from a texture's alpha.
+ *  Rows are packed into 64 bit words, so a hit test is one lookup and
+ *  a shift. Points are given in texture space normalised to [0, 1),
+ *  which makes the mask independent of the size a sprite is drawn at.
+ */
+class HitMask
+{
+ public:
+  enum
+  {
+    ALPHA_THRESHOLD = 128 /**< Pixels at or above this alpha are solid. */
+  };
+
+  bool load(const std::string& file_path);
+  void fill(int width, int height);
+
+  bool contains(float u, float v, bool flipped_x) const;
+  int width() const { return mask_width; }
+  int height() const { return mask_height; }
+  int solidPixels() const;
+
+ private:
+  void resize(int width, int height);
+  void set(int x, int y);
+
+  int mask_width = 0;
+  int mask_height = 0;
+  int words_per_row = 0;
+  std::vector<std::uint64_t> rows;
+};
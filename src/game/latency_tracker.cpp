@@ -0,0 +1,240 @@
+#include <cstdio>
+#include <iomanip>
+
+#include "latency_tracker.h"
+
+/**
+ *   @brief   Adds a sample to the histogram
+ *   @details Samples are bucketed in half millisecond steps, anything
+ *            past the last bucket is clamped into it but still counts
+ *            towards the mean and the maximum.
+ */
+
+void LatencyTracker::Histogram::add(Clock::duration sample)
+{
+  double sample_ms =
+    std::chrono::duration<double, std::milli>(sample).count();
+  auto bucket = static_cast<long>(sample_ms * 1000.0 / BUCKET_WIDTH_US);
+  if (bucket < 0)
+  {
+    bucket = 0;
+  }
+  if (bucket >= BUCKET_COUNT)
+  {
+    bucket = BUCKET_COUNT - 1;
+  }
+  buckets[bucket]++;
+  samples++;
+  total_ms += sample_ms;
+  if (sample_ms > max_ms)
+  {
+    max_ms = sample_ms;
+  }
+}
+
+/**
+ *   @brief   Estimates a percentile from the buckets
+ *   @details Returns the upper edge of the bucket the percentile
+ *            falls in, so the figure errs on the pessimistic side.
+ *   @return  The latency in milliseconds
+ */
+
+double LatencyTracker::Histogram::percentile(double fraction) const
+{
+  if (samples == 0)
+  {
+    return 0;
+  }
+  auto wanted =
+    static_cast<unsigned long>(fraction * static_cast<double>(samples));
+  unsigned long seen = 0;
+  for (int i = 0; i < BUCKET_COUNT; i++)
+  {
+    seen += buckets[i];
+    if (seen > wanted)
+    {
+      double edge = (i + 1) * BUCKET_WIDTH_US / 1000.0;
+      return edge < max_ms ? edge : max_ms;
+    }
+  }
+  return max_ms;
+}
+
+double LatencyTracker::Histogram::mean() const
+{
+  return samples == 0 ? 0 : total_ms / static_cast<double>(samples);
+}
+
+double LatencyTracker::Histogram::max() const
+{
+  return max_ms;
+}
+
+void LatencyTracker::Histogram::dump(std::ostream& out) const
+{
+  unsigned long largest = 0;
+  for (unsigned long bucket : buckets)
+  {
+    largest = bucket > largest ? bucket : largest;
+  }
+  out << std::fixed << std::setprecision(1);
+  for (int i = 0; i < BUCKET_COUNT; i++)
+  {
+    if (buckets[i] == 0)
+    {
+      continue;
+    }
+    auto bar = static_cast<int>(40 * buckets[i] / largest);
+    out << std::setw(6) << i * BUCKET_WIDTH_US / 1000.0 << "ms "
+        << std::string(static_cast<size_t>(bar > 0 ? bar : 1), '#') << ' '
+        << buckets[i] << '\n';
+  }
+}
+
+/**
+ *   @brief   Stamps the moment a click reaches the game
+ *   @details Called from the first registered click callback so the
+ *            stamp is taken before any other game code sees the event.
+ *            When more clicks are in flight than there are slots the
+ *            oldest one is dropped.
+ *   @return  The click's ticket for the later stages.
+ */
+
+long LatencyTracker::clickReceived()
+{
+  long ticket = next_ticket++;
+  Click& click = clicks[ticket % MAX_IN_FLIGHT];
+  click.received = Clock::now();
+  click.ticket = ticket;
+  click.state = RECEIVED;
+  return ticket;
+}
+
+/**
+ *   @brief   Finds a ticket's click in the state it is expected in
+ *   @return  nullptr for no ticket, or a click dropped meanwhile.
+ */
+
+LatencyTracker::Click* LatencyTracker::find(long ticket, ClickState state)
+{
+  if (ticket < 0)
+  {
+    return nullptr;
+  }
+  Click& click = clicks[ticket % MAX_IN_FLIGHT];
+  return click.ticket == ticket && click.state == state ? &click : nullptr;
+}
+
+void LatencyTracker::clickDispatched(long ticket)
+{
+  Click* click = find(ticket, RECEIVED);
+  if (click == nullptr)
+  {
+    return;
+  }
+  histograms[DISPATCHED].add(Clock::now() - click->received);
+  click->state = DISPATCHING;
+}
+
+void LatencyTracker::clickApplied(long ticket)
+{
+  Click* click = find(ticket, DISPATCHING);
+  if (click == nullptr)
+  {
+    return;
+  }
+  histograms[APPLIED].add(Clock::now() - click->received);
+  click->state = WAITING_FRAME;
+}
+
+/**
+ *   @brief   Frees the slot of a click the game did not act on
+ */
+
+void LatencyTracker::clickDropped(long ticket)
+{
+  Click* click = find(ticket, RECEIVED);
+  if (click != nullptr)
+  {
+    click->state = FREE;
+  }
+}
+
+/**
+ *   @brief   Marks every applied click as drawn
+ *   @details Called at the end of render, anything applied before
+ *            this point is part of the frame about to be swapped.
+ */
+
+void LatencyTracker::frameRendered()
+{
+  for (auto& click : clicks)
+  {
+    if (click.state == WAITING_FRAME)
+    {
+      click.state = DRAWN;
+    }
+  }
+}
+
+/**
+ *   @brief   Records the photon latency of every drawn click
+ *   @details Called at the start of update, which the engine only
+ *            reaches after the previous frame's swapBuffers returned.
+ */
+
+void LatencyTracker::framePresented()
+{
+  auto now = Clock::now();
+  for (auto& click : clicks)
+  {
+    if (click.state == DRAWN)
+    {
+      histograms[PRESENTED].add(now - click.received);
+      click.state = FREE;
+      hud_dirty = true;
+    }
+  }
+}
+
+/**
+ *   @brief   One line latency summary for the HUD
+ *   @details Only rebuilt when a new click was presented.
+ *   @return  The cached summary text
+ */
+
+const std::string& LatencyTracker::hudText()
+{
+  if (hud_dirty)
+  {
+    const Histogram& photon = histograms[PRESENTED];
+    char line[128];
+    std::snprintf(line,
+                  sizeof(line),
+                  "Click->photon p50 %.1fms p95 %.1fms max %.1fms n=%lu",
+                  photon.percentile(0.5),
+                  photon.percentile(0.95),
+                  photon.max(),
+                  photon.count());
+    hud_text = line;
+    hud_dirty = false;
+  }
+  return hud_text;
+}
+
+void LatencyTracker::dump(std::ostream& out) const
+{
+  const char* names[STAGE_COUNT] = { "receipt -> dequeued",
+                                     "receipt -> applied",
+                                     "receipt -> photon" };
+  for (int i = 0; i < STAGE_COUNT; i++)
+  {
+    const Histogram& stage = histograms[i];
+    out << std::fixed << std::setprecision(2) << names[i]
+        << ": n=" << stage.count() << " mean " << stage.mean() << "ms p50 "
+        << stage.percentile(0.5) << "ms p95 " << stage.percentile(0.95)
+        << "ms p99 " << stage.percentile(0.99) << "ms max " << stage.max()
+        << "ms\n";
+    stage.dump(out);
+  }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ *  Tracks each click from the moment the engine hands it to the game
+ *  until the first buffer swap that shows its result. Receipt hands
+ *  out a ticket that travels with the click, so clicks queued in the
+ *  same frame are each timed against their own receipt.
+ */
+class LatencyTracker
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum Stage
+  {
+    DISPATCHED = 0, /**< Receipt until the next update takes it from the
+                         input queue, the time spent queued included. */
+    APPLIED = 1,    /**< Receipt until the score and life change is made. */
+    PRESENTED = 2,  /**< Receipt until the frame showing it is swapped. */
+    STAGE_COUNT = 3
+  };
+
+  enum
+  {
+    MAX_IN_FLIGHT = 16,
+    BUCKET_COUNT = 64,
+    BUCKET_WIDTH_US = 500
+  };
+
+  /**
+   *  A fixed size latency histogram with half millisecond buckets,
+   *  the last bucket collects everything above 31.5ms.
+   */
+  class Histogram
+  {
+   public:
+    void add(Clock::duration sample);
+    double percentile(double fraction) const;
+    double mean() const;
+    double max() const;
+    unsigned long count() const { return samples; }
+    void dump(std::ostream& out) const;
+
+   private:
+    unsigned long buckets[BUCKET_COUNT] = { 0 };
+    unsigned long samples = 0;
+    double total_ms = 0;
+    double max_ms = 0;
+  };
+
+  long clickReceived();
+  void clickDispatched(long ticket);
+  void clickApplied(long ticket);
+  void clickDropped(long ticket);
+  void frameRendered();
+  void framePresented();
+
+  const Histogram& histogram(Stage stage) const { return histograms[stage]; }
+  const std::string& hudText();
+  void dump(std::ostream& out) const;
+
+ private:
+  enum ClickState
+  {
+    FREE,
+    RECEIVED,
+    DISPATCHING,
+    WAITING_FRAME,
+    DRAWN
+  };
+
+  struct Click
+  {
+    Clock::time_point received;
+    long ticket = -1;
+    ClickState state = FREE;
+  };
+
+  Click* find(long ticket, ClickState state);
+
+  Click clicks[MAX_IN_FLIGHT];
+  long next_ticket = 0;
+  Histogram histograms[STAGE_COUNT];
+  std::string hud_text;
+  bool hud_dirty = true;
+};
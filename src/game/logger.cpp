@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "logger.h"
+
+std::atomic<int> Logger::minimum_level{ NEMO_LOG_MIN_LEVEL };
+const Logger::Clock::time_point Logger::epoch = Logger::Clock::now();
+
+namespace
+{
+  const char* const LEVEL_NAMES[] = { "trace", "debug", "info", "warn",
+                                      "error" };
+}
+
+Logger::Logger()
+{
+  writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger()
+{
+  stopping = true;
+  writer.join();
+}
+
+/**
+ *   @brief   The logger shared by every thread
+ *   @details Created by the first message, so the writer thread only
+ *            exists once something is logged. It outlives main and
+ *            writes whatever is left when the program exits.
+ */
+
+Logger& Logger::instance()
+{
+  static Logger logger;
+  return logger;
+}
+
+Logger::Ring& Logger::localRing()
+{
+  thread_local Ring* ring = nullptr;
+  if (ring == nullptr)
+  {
+    Logger& logger = instance();
+    auto created = std::make_unique<Ring>();
+    ring = created.get();
+    std::lock_guard<std::mutex> lock(logger.registry_mutex);
+    logger.rings.push_back(std::move(created));
+  }
+  return *ring;
+}
+
+/**
+ *   @brief   Finds the slot the calling thread's next record goes in
+ *   @return  nullptr when the ring is full and the record is dropped.
+ */
+
+Logger::Record* Logger::claim()
+{
+  Ring& ring = localRing();
+  size_t tail = ring.tail.load(std::memory_order_relaxed);
+  if (tail - ring.head.load(std::memory_order_acquire) >= RECORDS_PER_THREAD)
+  {
+    ring.dropped++;
+    return nullptr;
+  }
+  return &ring.records[tail % RECORDS_PER_THREAD];
+}
+
+void Logger::publish()
+{
+  Ring& ring = localRing();
+  ring.tail.store(ring.tail.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_release);
+}
+
+/**
+ *   @brief   Copies a string argument into the record
+ *   @details Strings are truncated to the room left in the record.
+ */
+
+void Logger::add(Record& record, const char* value)
+{
+  if (record.arg_count >= ARGS_PER_RECORD)
+  {
+    return;
+  }
+  Arg& arg = record.args[record.arg_count++];
+  arg.kind = Arg::TEXT;
+  if (record.text_used >= TEXT_BYTES)
+  {
+    // out of room, point at the terminator of the last string
+    arg.text_offset = TEXT_BYTES - 1;
+    return;
+  }
+  arg.text_offset = record.text_used;
+  auto room = static_cast<size_t>(TEXT_BYTES - record.text_used - 1);
+  size_t length = std::min(std::strlen(value), room);
+  std::memcpy(record.text + record.text_used, value, length);
+  record.text[record.text_used + static_cast<int>(length)] = '\0';
+  record.text_used += static_cast<int>(length) + 1;
+}
+
+/**
+ *   @brief   Logs every line of a block of text
+ *   @details For reports built with an ostream, which are not on any
+ *            hot path. Each line is truncated to fit one record.
+ */
+
+void Logger::lines(Level level, const std::string& text)
+{
+  size_t start = 0;
+  while (start < text.size())
+  {
+    size_t end = text.find('\n', start);
+    if (end == std::string::npos)
+    {
+      end = text.size();
+    }
+    log(level, "{}", text.substr(start, end - start));
+    start = end + 1;
+  }
+}
+
+bool Logger::parseLevel(const char* name, Level& level)
+{
+  for (int i = LEVEL_TRACE; i <= LEVEL_ERROR; i++)
+  {
+    if (std::strcmp(name, LEVEL_NAMES[i]) == 0)
+    {
+      level = static_cast<Level>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ *   @brief   Blocks until every record queued so far is written
+ */
+
+void Logger::flush()
+{
+  Logger& logger = instance();
+  std::unique_lock<std::mutex> lock(logger.drain_mutex);
+  std::vector<size_t> targets;
+  {
+    std::lock_guard<std::mutex> registry_lock(logger.registry_mutex);
+    for (const auto& ring : logger.rings)
+    {
+      targets.push_back(ring->tail.load(std::memory_order_acquire));
+    }
+  }
+  logger.drained.wait(lock, [&logger, &targets] {
+    std::lock_guard<std::mutex> registry_lock(logger.registry_mutex);
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+      if (logger.rings[i]->head.load(std::memory_order_acquire) < targets[i])
+      {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+void Logger::writerLoop()
+{
+  std::string out;
+  for (;;)
+  {
+    bool stop = stopping.load();
+    drain(out);
+    if (!out.empty())
+    {
+      std::cout << out << std::flush;
+      out.clear();
+    }
+    drained.notify_all();
+    if (stop)
+    {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+  }
+}
+
+/**
+ *   @brief   Formats every queued record, oldest first
+ *   @return  The number of records formatted.
+ */
+
+size_t Logger::drain(std::string& out)
+{
+  std::vector<const Record*> batch;
+  std::vector<Ring*> drained_rings;
+  std::vector<size_t> tails;
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& ring : rings)
+    {
+      size_t head = ring->head.load(std::memory_order_relaxed);
+      size_t tail = ring->tail.load(std::memory_order_acquire);
+      for (size_t i = head; i < tail; i++)
+      {
+        batch.push_back(&ring->records[i % RECORDS_PER_THREAD]);
+      }
+      long dropped = ring->dropped.exchange(0);
+      if (dropped > 0)
+      {
+        char line[64];
+        std::snprintf(
+          line, sizeof(line), "[log] %ld messages dropped\n", dropped);
+        out += line;
+      }
+      drained_rings.push_back(ring.get());
+      tails.push_back(tail);
+    }
+  }
+
+  std::stable_sort(batch.begin(),
+                   batch.end(),
+                   [](const Record* first, const Record* second) {
+                     return first->time_ns < second->time_ns;
+                   });
+  for (const Record* record : batch)
+  {
+    format(*record, out);
+  }
+
+  // the slots are only handed back once they have been formatted
+  std::lock_guard<std::mutex> lock(drain_mutex);
+  for (size_t i = 0; i < drained_rings.size(); i++)
+  {
+    drained_rings[i]->head.store(tails[i], std::memory_order_release);
+  }
+  return batch.size();
+}
+
+void Logger::format(const Record& record, std::string& out)
+{
+  char prefix[32];
+  std::snprintf(prefix,
+                sizeof(prefix),
+                "[%10.3f %-5s] ",
+                static_cast<double>(record.time_ns) / 1e9,
+                LEVEL_NAMES[record.level]);
+  out += prefix;
+
+  int next_arg = 0;
+  for (const char* c = record.format; *c != '\0'; c++)
+  {
+    if (c[0] != '{' || c[1] != '}' || next_arg >= record.arg_count)
+    {
+      out += *c;
+      continue;
+    }
+    const Arg& arg = record.args[next_arg++];
+    char value[32];
+    switch (arg.kind)
+    {
+      case Arg::INTEGER:
+        std::snprintf(value, sizeof(value), "%lld", arg.integer);
+        out += value;
+        break;
+      case Arg::REAL:
+        std::snprintf(value, sizeof(value), "%g", arg.real);
+        out += value;
+        break;
+      case Arg::TEXT:
+        out += record.text + arg.text_offset;
+        break;
+    }
+    c++;
+  }
+  out += '\n';
+}
+
+/**
+ *   @brief   Checks a message against the call site's budget
+ *   @details Budgets run in one second windows. The window check is
+ *            not exact under contention, which only matters to the
+ *            count of a second that is already over budget.
+ */
+
+bool LogRateLimit::allow()
+{
+  long long now = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  long long current = window.load(std::memory_order_relaxed);
+  if (current != now && window.compare_exchange_strong(current, now))
+  {
+    used = 0;
+  }
+  if (used.fetch_add(1) < limit)
+  {
+    return true;
+  }
+  suppressed++;
+  return false;
+}
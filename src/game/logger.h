@@ -0,0 +1,239 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Messages below NEMO_LOG_MIN_LEVEL sit behind a constant false branch,
+ * so they are still type checked but the compiler drops them and their
+ * arguments are never evaluated. 0 trace, 1 debug, 2 info, 3 warnings,
+ * 4 errors.
+ */
+#ifndef NEMO_LOG_MIN_LEVEL
+#  ifdef NDEBUG
+#    define NEMO_LOG_MIN_LEVEL 2
+#  else
+#    define NEMO_LOG_MIN_LEVEL 1
+#  endif
+#endif
+
+/**
+ *  An asynchronous logger.
+ *  A call only copies the format string pointer and its arguments into
+ *  the calling thread's ring of records, no lock is taken and nothing
+ *  is formatted. A background writer drains every ring, substitutes
+ *  the arguments for the {} in the format and writes to the console.
+ *  A full ring drops the record rather than wait for the writer.
+ */
+class Logger
+{
+ public:
+  enum Level
+  {
+    LEVEL_TRACE = 0,
+    LEVEL_DEBUG = 1,
+    LEVEL_INFO = 2,
+    LEVEL_WARN = 3,
+    LEVEL_ERROR = 4
+  };
+
+  enum
+  {
+    RECORDS_PER_THREAD = 512,
+    ARGS_PER_RECORD = 4,
+    TEXT_BYTES = 96, /**< Room for the string arguments of a record. */
+    DRAIN_INTERVAL_MS = 10
+  };
+
+  /**
+   *   @brief   Queues a message for the writer
+   *   @param   format Must outlive the logger, so a string literal.
+   *   @param   args Numbers, or strings which are copied.
+   */
+
+  template<typename... Args>
+  static void log(Level level, const char* format, const Args&... args)
+  {
+    if (level < minimum_level.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+    Record* record = claim();
+    if (record == nullptr)
+    {
+      return;
+    }
+    record->level = level;
+    record->format = format;
+    record->time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - epoch)
+                        .count();
+    record->arg_count = 0;
+    record->text_used = 0;
+    pack(*record, args...);
+    publish();
+  }
+
+  static void lines(Level level, const std::string& text);
+  static void minimumLevel(Level level) { minimum_level = level; }
+  static bool parseLevel(const char* name, Level& level);
+  static void flush();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Arg
+  {
+    enum Kind
+    {
+      INTEGER,
+      REAL,
+      TEXT
+    } kind;
+    union
+    {
+      long long integer;
+      double real;
+      int text_offset;
+    };
+  };
+
+  struct Record
+  {
+    Level level;
+    const char* format;
+    std::int64_t time_ns;
+    int arg_count;
+    int text_used;
+    Arg args[ARGS_PER_RECORD];
+    char text[TEXT_BYTES];
+  };
+
+  /**
+   *  A single producer, single consumer ring owned by one thread.
+   */
+  struct Ring
+  {
+    Record records[RECORDS_PER_THREAD];
+    std::atomic<size_t> head{ 0 }; /**< Next record the writer reads. */
+    std::atomic<size_t> tail{ 0 }; /**< Next record the owner writes. */
+    std::atomic<long> dropped{ 0 };
+  };
+
+  Logger();
+  ~Logger();
+  static Logger& instance();
+  static Ring& localRing();
+  static Record* claim();
+  static void publish();
+
+  static void pack(Record&) {}
+  template<typename T, typename... Rest>
+  static void pack(Record& record, const T& value, const Rest&... rest)
+  {
+    add(record, value);
+    pack(record, rest...);
+  }
+  template<typename T>
+  static typename std::enable_if<std::is_integral<T>::value>::type
+  add(Record& record, T value)
+  {
+    if (record.arg_count < ARGS_PER_RECORD)
+    {
+      Arg& arg = record.args[record.arg_count++];
+      arg.kind = Arg::INTEGER;
+      arg.integer = static_cast<long long>(value);
+    }
+  }
+  template<typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type
+  add(Record& record, T value)
+  {
+    if (record.arg_count < ARGS_PER_RECORD)
+    {
+      Arg& arg = record.args[record.arg_count++];
+      arg.kind = Arg::REAL;
+      arg.real = static_cast<double>(value);
+    }
+  }
+  static void add(Record& record, const char* value);
+  static void add(Record& record, const std::string& value)
+  {
+    add(record, value.c_str());
+  }
+
+  void writerLoop();
+  size_t drain(std::string& out);
+  static void format(const Record& record, std::string& out);
+
+  static std::atomic<int> minimum_level;
+  static const Clock::time_point epoch;
+
+  std::mutex registry_mutex;
+  std::vector<std::unique_ptr<Ring>> rings;
+  std::mutex drain_mutex;
+  std::condition_variable drained;
+  std::thread writer;
+  std::atomic<bool> stopping{ false };
+};
+
+/**
+ *  Lets through at most a number of messages a second from one call
+ *  site and counts the rest.
+ */
+class LogRateLimit
+{
+ public:
+  explicit LogRateLimit(int per_second) : limit(per_second) {}
+  bool allow();
+  long takeSuppressed() { return suppressed.exchange(0); }
+
+ private:
+  int limit;
+  std::atomic<long long> window{ -1 };
+  std::atomic<int> used{ 0 };
+  std::atomic<long> suppressed{ 0 };
+};
+
+#define NEMO_LOG_AT(level, ...)                                                \
+  do                                                                           \
+  {                                                                            \
+    if (Logger::level >= NEMO_LOG_MIN_LEVEL)                                   \
+    {                                                                          \
+      Logger::log(Logger::level, __VA_ARGS__);                                 \
+    }                                                                          \
+  } while (0)
+
+#define NEMO_LOG_LIMITED(level, per_second, ...)                               \
+  do                                                                           \
+  {                                                                            \
+    if (Logger::level >= NEMO_LOG_MIN_LEVEL)                                   \
+    {                                                                          \
+      static LogRateLimit log_limit(per_second);                               \
+      if (log_limit.allow())                                                   \
+      {                                                                        \
+        long log_skipped = log_limit.takeSuppressed();                         \
+        if (log_skipped > 0)                                                   \
+        {                                                                      \
+          Logger::log(                                                         \
+            Logger::level, "({} similar messages suppressed)", log_skipped);   \
+        }                                                                      \
+        Logger::log(Logger::level, __VA_ARGS__);                               \
+      }                                                                        \
+    }                                                                          \
+  } while (0)
+
+#define LOG_TRACE(...) NEMO_LOG_AT(LEVEL_TRACE, __VA_ARGS__)
+#define LOG_DEBUG(...) NEMO_LOG_AT(LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_DEBUG_LIMITED(per_second, ...)                                     \
+  NEMO_LOG_LIMITED(LEVEL_DEBUG, per_second, __VA_ARGS__)
+#define LOG_INFO(...) NEMO_LOG_AT(LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) NEMO_LOG_AT(LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) NEMO_LOG_AT(LEVEL_ERROR, __VA_ARGS__)
@@ -1,11 +1,141 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
 #include "game.h"
+#include "logger.h"
+#include "session_host.h"
+#include "trace_recorder.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+  GameOptions options;
+  int headless_frames = -1;
+  int sessions = 0;
+  int workers = 1;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+    {
+      options.target_fps = std::atoi(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc)
+    {
+      options.frame_budget_ms = std::atof(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--endless") == 0)
+    {
+      options.endless = true;
+    }
+    else if (std::strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+    {
+      headless_frames = std::atoi(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--tuning") == 0 && i + 1 < argc)
+    {
+      options.tuning_file = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--sessions") == 0 && i + 1 < argc)
+    {
+      sessions = std::atoi(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+    {
+      workers = std::atoi(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+    {
+      options.seed =
+        static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+      options.seeded = true;
+    }
+    else if (std::strcmp(argv[i], "--attract") == 0)
+    {
+      options.attract = true;
+    }
+    else if (std::strcmp(argv[i], "--alloc-budget") == 0 && i + 1 < argc)
+    {
+      options.alloc_budget = std::atol(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--serial") == 0)
+    {
+      options.serial = true;
+    }
+    else if (std::strcmp(argv[i], "--render-check") == 0)
+    {
+      options.render_check = true;
+    }
+    else if (std::strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+    {
+      Logger::Level level = Logger::LEVEL_INFO;
+      if (Logger::parseLevel(argv[++i], level))
+      {
+        Logger::minimumLevel(level);
+      }
+    }
+    else if (std::strcmp(argv[i], "--trace") == 0)
+    {
+      TraceRecorder::start();
+    }
+    else if (std::strcmp(argv[i], "--export-state") == 0)
+    {
+      // the shared memory name is optional
+      options.export_name = STATE_EXPORT_DEFAULT_NAME;
+      if (i + 1 < argc && argv[i + 1][0] == '/')
+      {
+        options.export_name = argv[++i];
+      }
+    }
+  }
+
+  // the headless bot starts a game on its first frame, which would end
+  // the attract screen at once, and hosted sessions run headless
+  if (options.attract && (sessions > 0 || headless_frames >= 0))
+  {
+    LOG_ERROR("--attract needs a window, not --headless or --sessions");
+    return EXIT_FAILURE;
+  }
+
+  if (sessions > 0)
+  {
+    // hosted sessions are unpaced and windowless, and one shared
+    // memory block cannot show many games
+    if (options.target_fps >= 0 || !options.export_name.empty() ||
+        options.render_check)
+    {
+      LOG_ERROR("host: --fps, --export-state and --render-check need a "
+                "single game, not --sessions");
+      return EXIT_FAILURE;
+    }
+    // hosted sessions have no window, so they always run headless
+    SessionHost host(sessions, workers, options);
+    if (!host.init() || !host.run(headless_frames > 0 ? headless_frames : 0))
+    {
+      return EXIT_FAILURE;
+    }
+    return 0;
+  }
+
+  if (options.render_check && headless_frames < 0)
+  {
+    LOG_ERROR("--render-check needs --headless");
+    return EXIT_FAILURE;
+  }
+
   MyASGEGame asge_game;
-  if (asge_game.init())
+  asge_game.configure(options);
+  if (headless_frames >= 0)
+  {
+    if (!asge_game.initHeadless() ||
+        !asge_game.runHeadless(headless_frames))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  else if (asge_game.init())
   {
+    asge_game.attractMode(options.attract);
     asge_game.run();
   }
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,102 @@
+#include <cstdio>
+
+#include "memory_ledger.h"
+
+namespace
+{
+  double kilobytes(size_t bytes)
+  {
+    return static_cast<double>(bytes) / 1024.0;
+  }
+}
+
+const char* MemoryLedger::name(Subsystem subsystem)
+{
+  switch (subsystem)
+  {
+    case FISH:
+      return "fish";
+    case SPRITES:
+      return "sprites";
+    case TEXTURES:
+      return "textures";
+    case TEXT:
+      return "text";
+    case EFFECTS:
+      return "effects";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ *   @brief   Starts a new accounting pass
+ */
+
+void MemoryLedger::begin()
+{
+  for (auto& subsystem_total : totals)
+  {
+    subsystem_total = 0;
+  }
+}
+
+void MemoryLedger::add(Subsystem subsystem, size_t bytes)
+{
+  totals[subsystem] += bytes;
+}
+
+/**
+ *   @brief   Closes an accounting pass
+ *   @details Rebuilds the HUD line, so rendering the HUD does no
+ *            formatting.
+ */
+
+void MemoryLedger::end()
+{
+  char line[160];
+  std::snprintf(line,
+                sizeof(line),
+                "Memory %.0fKB: fish %.0f, sprites %.0f, textures %.0f, "
+                "text %.1f, effects %.0f",
+                kilobytes(total()),
+                kilobytes(totals[FISH]),
+                kilobytes(totals[SPRITES]),
+                kilobytes(totals[TEXTURES]),
+                kilobytes(totals[TEXT]),
+                kilobytes(totals[EFFECTS]));
+  hud_text = line;
+}
+
+size_t MemoryLedger::total() const
+{
+  size_t sum = 0;
+  for (auto subsystem_total : totals)
+  {
+    sum += subsystem_total;
+  }
+  return sum;
+}
+
+/**
+ *   @brief   Writes the full report
+ *   @param   out The stream to write to.
+ */
+
+void MemoryLedger::dump(std::ostream& out) const
+{
+  char line[96];
+  for (int i = 0; i < SUBSYSTEM_COUNT; i++)
+  {
+    auto subsystem = static_cast<Subsystem>(i);
+    std::snprintf(line,
+                  sizeof(line),
+                  "  %-9s %10zu bytes\n",
+                  name(subsystem),
+                  totals[i]);
+    out << line;
+  }
+  std::snprintf(
+    line, sizeof(line), "  %-9s %10zu bytes\n", "total", total());
+  out << line;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+/**
+ *  A breakdown of the memory a game session holds, by subsystem.
+ *  The figures are the sizes and capacities of what the game
+ *  allocated at init, not measured heap use; AllocTracker counts the
+ *  allocations themselves.
+ */
+class MemoryLedger
+{
+ public:
+  enum Subsystem
+  {
+    FISH = 0,     /**< Fish state, snapshots, history, school, scheduler. */
+    SPRITES = 1,  /**< Sprite objects owned by the sprite arena. */
+    TEXTURES = 2, /**< Pixel data of the textures in use. */
+    TEXT = 3,     /**< Strings the game keeps for rendering text. */
+    EFFECTS = 4,  /**< The particle pool. */
+    SUBSYSTEM_COUNT = 5
+  };
+
+  void begin();
+  void add(Subsystem subsystem, size_t bytes);
+  void end();
+
+  size_t bytes(Subsystem subsystem) const { return totals[subsystem]; }
+  size_t total() const;
+  const std::string& hudText() const { return hud_text; }
+  void dump(std::ostream& out) const;
+
+  static const char* name(Subsystem subsystem);
+
+ private:
+  size_t totals[SUBSYSTEM_COUNT] = { 0 };
+  std::string hud_text;
+};
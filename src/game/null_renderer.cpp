@@ -0,0 +1,205 @@
+#include <utility>
+
+#include "asset_store.h"
+#include "null_renderer.h"
+
+NullTexture::NullTexture(std::string path) :
+  ASGE::Texture2D(1, 1), file(std::move(path))
+{
+  setFormat(RGBA);
+}
+
+void NullTexture::setData(void*) {}
+
+void* NullTexture::getData()
+{
+  return nullptr;
+}
+
+/**
+ *   @brief   Pretends to load a texture
+ *   @details Always succeeds, the path is kept so tests can check which
+ *            asset a sprite was given. Textures the asset store holds
+ *            are shared instead of copied.
+ *   @return  true
+ */
+
+bool NullSprite::loadTexture(const std::string& path)
+{
+  shared = assets != nullptr ? assets->texture(path) : nullptr;
+  if (shared == nullptr)
+  {
+    texture = std::make_unique<NullTexture>(path);
+  }
+  else
+  {
+    texture.reset();
+  }
+  return true;
+}
+
+const ASGE::Texture2D* NullSprite::getTexture() const
+{
+  return shared != nullptr ? shared : texture.get();
+}
+
+bool NullInput::init(ASGE::Renderer*)
+{
+  use_threads = false;
+  return true;
+}
+
+void NullInput::update() {}
+
+void NullInput::getCursorPos(double& xpos, double& ypos) const
+{
+  xpos = 0;
+  ypos = 0;
+}
+
+void NullInput::setCursorMode(ASGE::MOUSE::CursorMode) {}
+
+const ASGE::GamePadData NullInput::getGamePad(int idx) const
+{
+  return ASGE::GamePadData(idx, "null", 0, nullptr, 0, nullptr);
+}
+
+NullRenderer::NullRenderer() : ASGE::Renderer(RenderLib::INVALID) {}
+
+void NullRenderer::setClearColour(ASGE::Colour rgb)
+{
+  cls = rgb;
+}
+
+int NullRenderer::loadFont(const char*, int)
+{
+  return 0;
+}
+
+int NullRenderer::loadFontFromMem(const char*,
+                                  const unsigned char*,
+                                  unsigned int,
+                                  int)
+{
+  return 0;
+}
+
+bool NullRenderer::init(int, int, ASGE::Renderer::WindowMode mode)
+{
+  window_mode = mode;
+  return true;
+}
+
+bool NullRenderer::exit()
+{
+  return true;
+}
+
+/**
+ *   @brief   Starts a new frame
+ *   @details Clears the draw records of the previous frame.
+ */
+
+void NullRenderer::preRender()
+{
+  sprites.clear();
+  texts.clear();
+}
+
+void NullRenderer::postRender() {}
+
+void NullRenderer::renderText(std::string str,
+                              int x,
+                              int y,
+                              float,
+                              const ASGE::Colour&,
+                              float)
+{
+  total_text_draws++;
+  if (recording)
+  {
+    TextDraw draw;
+    draw.text = std::move(str);
+    draw.x = x;
+    draw.y = y;
+    texts.push_back(std::move(draw));
+  }
+}
+
+void NullRenderer::setDefaultTextColour(const ASGE::Colour& colour)
+{
+  default_text_colour = colour;
+}
+
+ASGE::SHADER_LIB::Shader* NullRenderer::findShader(int)
+{
+  return nullptr;
+}
+
+const ASGE::Font& NullRenderer::getActiveFont() const
+{
+  return font;
+}
+
+void NullRenderer::setFont(int) {}
+
+/**
+ *   @brief   Counts a sprite draw
+ *   @details When recording, the sprite's state is copied as it was at
+ *            submission, later changes to the sprite are not seen.
+ */
+
+void NullRenderer::renderSprite(const ASGE::Sprite& sprite, float)
+{
+  total_sprite_draws++;
+  if (recording)
+  {
+    SpriteDraw draw;
+    draw.sprite = &sprite;
+    draw.x = sprite.xPos();
+    draw.y = sprite.yPos();
+    draw.width = sprite.width();
+    draw.height = sprite.height();
+    draw.flipped_x = sprite.isFlippedOnX();
+    draw.colour = sprite.colour();
+    sprites.push_back(draw);
+  }
+}
+
+void NullRenderer::setSpriteMode(ASGE::SpriteSortMode) {}
+
+void NullRenderer::setWindowedMode(ASGE::Renderer::WindowMode mode)
+{
+  window_mode = mode;
+}
+
+void NullRenderer::setWindowTitle(const char*) {}
+
+void NullRenderer::swapBuffers()
+{
+  frame_count++;
+}
+
+std::unique_ptr<ASGE::Input> NullRenderer::inputPtr()
+{
+  return std::make_unique<NullInput>();
+}
+
+std::unique_ptr<ASGE::Sprite> NullRenderer::createUniqueSprite()
+{
+  sprites_created++;
+  return std::make_unique<NullSprite>(assets);
+}
+
+ASGE::Sprite* NullRenderer::createRawSprite()
+{
+  sprites_created++;
+  return new NullSprite(assets);
+}
+
+int NullRenderer::initPixelShader(std::string)
+{
+  return -1;
+}
+
+void NullRenderer::setActiveShader(ASGE::SHADER_LIB::Shader*) {}
@@ -0,0 +1,146 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Engine/Font.h>
+#include <Engine/Input.h>
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+#include <Engine/Texture.h>
+
+class AssetStore;
+
+/**
+ *  A texture that only remembers where it was loaded from.
+ */
+class NullTexture : public ASGE::Texture2D
+{
+ public:
+  explicit NullTexture(std::string path);
+  void setData(void* data) override;
+  void* getData() override;
+  const std::string& path() const { return file; }
+
+ private:
+  std::string file;
+};
+
+/**
+ *  A sprite that keeps its state in memory and never touches a GPU.
+ *  Given an asset store, textures it preloads are shared rather than
+ *  created per sprite.
+ */
+class NullSprite : public ASGE::Sprite
+{
+ public:
+  explicit NullSprite(const AssetStore* store = nullptr) : assets(store) {}
+  bool loadTexture(const std::string& path) override;
+  const ASGE::Texture2D* getTexture() const override;
+
+ private:
+  const AssetStore* assets;
+  const NullTexture* shared = nullptr;
+  std::unique_ptr<NullTexture> texture;
+};
+
+/**
+ *  An input system with no window behind it.
+ *  Events can still be injected with sendEvent.
+ */
+class NullInput : public ASGE::Input
+{
+ public:
+  bool init(ASGE::Renderer* renderer) override;
+  void update() override;
+  void getCursorPos(double& xpos, double& ypos) const override;
+  void setCursorMode(ASGE::MOUSE::CursorMode mode) override;
+  const ASGE::GamePadData getGamePad(int idx) const override;
+};
+
+/**
+ *  A renderer backend that records what it was asked to draw.
+ *  Lets the unmodified game run on machines without a GPU or a
+ *  display, for frame cost benchmarks and render output checks.
+ */
+class NullRenderer : public ASGE::Renderer
+{
+ public:
+  /**
+   *  The state of a sprite at the moment it was submitted.
+   */
+  struct SpriteDraw
+  {
+    const ASGE::Sprite* sprite = nullptr;
+    float x = 0;
+    float y = 0;
+    float width = 0;
+    float height = 0;
+    bool flipped_x = false;
+    ASGE::Colour colour = ASGE::COLOURS::WHITE;
+  };
+
+  /**
+   *  A line of text as it was submitted.
+   */
+  struct TextDraw
+  {
+    std::string text;
+    int x = 0;
+    int y = 0;
+  };
+
+  NullRenderer();
+
+  void setClearColour(ASGE::Colour rgb) override;
+  int loadFont(const char* font, int pt) override;
+  int loadFontFromMem(const char* name,
+                      const unsigned char* data,
+                      unsigned int size,
+                      int pt) override;
+  bool init(int w, int h, ASGE::Renderer::WindowMode mode) override;
+  bool exit() override;
+  void preRender() override;
+  void postRender() override;
+  void renderText(std::string str,
+                  int x,
+                  int y,
+                  float scale,
+                  const ASGE::Colour& colour,
+                  float z_order) override;
+  void setDefaultTextColour(const ASGE::Colour& colour) override;
+  ASGE::SHADER_LIB::Shader* findShader(int shader_handle) override;
+  const ASGE::Font& getActiveFont() const override;
+  void setFont(int id) override;
+  void renderSprite(const ASGE::Sprite& sprite, float z_order) override;
+  void setSpriteMode(ASGE::SpriteSortMode mode) override;
+  void setWindowedMode(ASGE::Renderer::WindowMode mode) override;
+  void setWindowTitle(const char* str) override;
+  void swapBuffers() override;
+  std::unique_ptr<ASGE::Input> inputPtr() override;
+  std::unique_ptr<ASGE::Sprite> createUniqueSprite() override;
+  ASGE::Sprite* createRawSprite() override;
+  int initPixelShader(std::string shader) override;
+  void setActiveShader(ASGE::SHADER_LIB::Shader* shader) override;
+
+  void recordDraws(bool record) { recording = record; }
+  bool recordingDraws() const { return recording; }
+  void shareAssets(const AssetStore* store) { assets = store; }
+  const std::vector<SpriteDraw>& spriteDraws() const { return sprites; }
+  const std::vector<TextDraw>& textDraws() const { return texts; }
+  unsigned long frames() const { return frame_count; }
+  unsigned long totalSpriteDraws() const { return total_sprite_draws; }
+  unsigned long totalTextDraws() const { return total_text_draws; }
+  unsigned long spritesCreated() const { return sprites_created; }
+
+ private:
+  ASGE::Font font;
+  const AssetStore* assets = nullptr;
+  bool recording = false;
+  std::vector<SpriteDraw> sprites; /**< Sprites submitted this frame. */
+  std::vector<TextDraw> texts;     /**< Text submitted this frame. */
+  unsigned long frame_count = 0;
+  unsigned long total_sprite_draws = 0;
+  unsigned long total_text_draws = 0;
+  unsigned long sprites_created = 0;
+};
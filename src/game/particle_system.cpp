@@ -0,0 +1,167 @@
+#include <chrono>
+#include <cmath>
+
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+
+#include "particle_system.h"
+
+namespace
+{
+  const float TWO_PI = 6.2831853f;
+}
+
+ParticleSystem::ParticleSystem(int pool_capacity) :
+  x(static_cast<size_t>(pool_capacity)),
+  y(static_cast<size_t>(pool_capacity)),
+  velocity_x(static_cast<size_t>(pool_capacity)),
+  velocity_y(static_cast<size_t>(pool_capacity)),
+  gravity(static_cast<size_t>(pool_capacity)),
+  life(static_cast<size_t>(pool_capacity)),
+  fade(static_cast<size_t>(pool_capacity)),
+  red(static_cast<size_t>(pool_capacity)),
+  green(static_cast<size_t>(pool_capacity)),
+  blue(static_cast<size_t>(pool_capacity))
+{
+}
+
+/**
+ *   @brief   A cheap uniform random number in [0, 1)
+ *   @details xorshift32, kept separate from the game's generator so
+ *            effects do not change which fish the game spawns.
+ */
+
+float ParticleSystem::random01()
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return static_cast<float>(seed >> 8) / 16777216.0f;
+}
+
+/**
+ *   @brief   Spawns a burst of particles at a point
+ *   @details The burst count is scaled by the current density. When
+ *            the pool is full the remaining particles are dropped.
+ */
+
+void ParticleSystem::emit(float at_x, float at_y, const Burst& burst)
+{
+  auto wanted = static_cast<int>(static_cast<float>(burst.count) *
+                                 density_scale);
+  int spawn_end = live + wanted < capacity() ? live + wanted : capacity();
+  for (auto i = static_cast<size_t>(live);
+       i < static_cast<size_t>(spawn_end);
+       i++)
+  {
+    float direction = random01() * TWO_PI;
+    float speed =
+      burst.speed_min + random01() * (burst.speed_max - burst.speed_min);
+    x[i] = at_x;
+    y[i] = at_y;
+    velocity_x[i] = std::cos(direction) * speed;
+    velocity_y[i] = std::sin(direction) * speed - burst.lift;
+    gravity[i] = burst.gravity;
+    life[i] = burst.lifetime * (0.5f + 0.5f * random01());
+    fade[i] = 1.0f / burst.lifetime;
+    red[i] = burst.colour.r;
+    green[i] = burst.colour.g;
+    blue[i] = burst.colour.b;
+  }
+  live = spawn_end;
+}
+
+/**
+ *   @brief   Integrates every live particle
+ *   @details Each pass is a straight loop over restrict pointers so it
+ *            vectorises. Dead particles are then swapped out with the
+ *            last live one to keep the live range packed.
+ */
+
+void ParticleSystem::update(float delta_seconds)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  float* __restrict pos_x = x.data();
+  float* __restrict pos_y = y.data();
+  float* __restrict vel_x = velocity_x.data();
+  float* __restrict vel_y = velocity_y.data();
+  const float* __restrict fall = gravity.data();
+  float* __restrict remaining = life.data();
+  const int count = live;
+
+  for (int i = 0; i < count; i++)
+  {
+    vel_y[i] += fall[i] * delta_seconds;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    pos_x[i] += vel_x[i] * delta_seconds;
+    pos_y[i] += vel_y[i] * delta_seconds;
+    remaining[i] -= delta_seconds;
+  }
+
+  int i = 0;
+  while (i < live)
+  {
+    if (remaining[i] > 0)
+    {
+      i++;
+      continue;
+    }
+    live--;
+    auto from = static_cast<size_t>(live);
+    auto to = static_cast<size_t>(i);
+    x[to] = x[from];
+    y[to] = y[from];
+    velocity_x[to] = velocity_x[from];
+    velocity_y[to] = velocity_y[from];
+    gravity[to] = gravity[from];
+    life[to] = life[from];
+    fade[to] = fade[from];
+    red[to] = red[from];
+    green[to] = green[from];
+    blue[to] = blue[from];
+  }
+
+  update_us = std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+}
+
+/**
+ *   @brief   Submits the live particles to the renderer
+ *   @details One shared sprite is moved from particle to particle.
+ *            Every draw uses the same texture, so a deferred sprite
+ *            mode collapses them into a single batch.
+ */
+
+void ParticleSystem::render(ASGE::Renderer& renderer,
+                            ASGE::Sprite& sprite) const
+{
+  float half_size = sprite.width() / 2;
+  for (size_t i = 0; i < static_cast<size_t>(live); i++)
+  {
+    const float rgb[3] = { red[i], green[i], blue[i] };
+    float opacity = life[i] * fade[i];
+    sprite.xPos(x[i] - half_size);
+    sprite.yPos(y[i] - half_size);
+    sprite.colour(rgb);
+    sprite.opacity(opacity < 1 ? opacity : 1);
+    renderer.renderSprite(sprite);
+  }
+}
+
+size_t ParticleSystem::bytes() const
+{
+  const std::vector<float>* arrays[] = {
+    &x, &y, &velocity_x, &velocity_y, &gravity,
+    &life, &fade, &red, &green, &blue
+  };
+  size_t total = 0;
+  for (const auto* array : arrays)
+  {
+    total += array->capacity() * sizeof(float);
+  }
+  return total;
+}
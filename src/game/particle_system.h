@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Engine/Colours.h>
+
+namespace ASGE
+{
+  class Renderer;
+  class Sprite;
+}
+
+/**
+ *  A fixed capacity particle pool stored as a structure of arrays.
+ *  Live particles are kept packed at the front of the arrays, a dead
+ *  particle is replaced by the last live one, so integration runs over
+ *  plain contiguous float arrays the compiler can vectorise.
+ */
+class ParticleSystem
+{
+ public:
+  /**
+   *  Describes the particles an emitter spawns.
+   */
+  struct Burst
+  {
+    int count;
+    float speed_min;
+    float speed_max;
+    float lift;     /**< Added upward velocity, in pixels per second. */
+    float gravity;  /**< Downward acceleration, in pixels per second². */
+    float lifetime; /**< In seconds. */
+    ASGE::Colour colour;
+  };
+
+  explicit ParticleSystem(int capacity);
+
+  void emit(float x, float y, const Burst& burst);
+  void update(float delta_seconds);
+  void render(ASGE::Renderer& renderer, ASGE::Sprite& sprite) const;
+  void clear() { live = 0; }
+  void density(float scale) { density_scale = scale; }
+
+  int liveCount() const { return live; }
+  int capacity() const { return static_cast<int>(x.size()); }
+  double updateMicros() const { return update_us; }
+  size_t bytes() const;
+
+ private:
+  float random01();
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> velocity_x;
+  std::vector<float> velocity_y;
+  std::vector<float> gravity;
+  std::vector<float> life; /**< Seconds left to live. */
+  std::vector<float> fade; /**< 1 / lifetime, scales life to opacity. */
+  std::vector<float> red;
+  std::vector<float> green;
+  std::vector<float> blue;
+  int live = 0;
+  float density_scale = 1.0f;
+  std::uint32_t seed = 0x9E3779B9u;
+  double update_us = 0;
+};
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <chrono>
+
+#include "logger.h"
+#include "session_host.h"
+#include "trace_recorder.h"
+
+SessionHost::SessionHost(int session_count,
+                         int worker_count,
+                         const GameOptions& game_options) :
+  options(game_options),
+  workers(std::max(1, std::min(worker_count, session_count)))
+{
+  sessions.reserve(static_cast<size_t>(session_count));
+  for (int i = 0; i < session_count; i++)
+  {
+    sessions.push_back(std::make_unique<MyASGEGame>());
+  }
+}
+
+SessionHost::~SessionHost()
+{
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    stopping = true;
+  }
+  batch_ready.notify_all();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  for (auto& session : sessions)
+  {
+    session->closeTelemetry();
+  }
+  telemetry_writer.stop();
+}
+
+/**
+ *   @brief   Loads the shared assets and starts every session
+ *   @details Sessions are seeded seed, seed + 1 and so on, so a run
+ *            can be repeated while no two sessions play the same game.
+ *            They simulate inline, the workers are their threads.
+ *   @return  False if any session failed to initialise.
+ */
+
+bool SessionHost::init()
+{
+  assets.load();
+  tuning = tuning_watcher.start(options.tuning_file);
+  for (size_t i = 0; i < sessions.size(); i++)
+  {
+    MyASGEGame& session = *sessions[i];
+    GameOptions session_options = options;
+    session_options.seed = options.seed + static_cast<unsigned>(i);
+    session_options.seeded = true;
+    session_options.serial = true;
+    session.configure(session_options);
+    session.shareAssets(&assets);
+    session.shareTelemetry(&telemetry_writer);
+    session.retune(tuning);
+    if (!session.initHeadless())
+    {
+      LOG_ERROR("host: session {} failed to initialise", i);
+      return false;
+    }
+  }
+  LOG_INFO("host: {} sessions sharing {} textures",
+           sessions.size(),
+           assets.textureCount());
+
+  // the calling thread is worker 0
+  for (int worker = 1; worker < workers; worker++)
+  {
+    threads.emplace_back(&SessionHost::workerLoop, this, worker);
+  }
+  return true;
+}
+
+/**
+ *   @brief   Runs every session for a number of frames
+ *   @details Frames are run in batches. Within a batch each worker
+ *            runs its own sessions with no synchronisation at all,
+ *            between batches the host picks up a reloaded tuning set
+ *            and hands it to every session.
+ *   @return  False if a session went over the allocation budget.
+ */
+
+bool SessionHost::run(int frames)
+{
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+
+  for (int first = 0; first < frames; first += FRAMES_PER_BATCH)
+  {
+    int count = std::min(static_cast<int>(FRAMES_PER_BATCH), frames - first);
+    {
+      std::lock_guard<std::mutex> lock(batch_mutex);
+      batch_first = first;
+      batch_frames = count;
+      workers_busy = workers - 1;
+      batch++;
+    }
+    batch_ready.notify_all();
+    runSessions(0, first, count);
+    {
+      std::unique_lock<std::mutex> lock(batch_mutex);
+      batch_done.wait(lock, [this] { return workers_busy == 0; });
+    }
+
+    std::string status;
+    if (tuning_watcher.poll(tuning, status))
+    {
+      LOG_INFO("{}", status);
+      for (auto& session : sessions)
+      {
+        session->retune(tuning);
+      }
+    }
+  }
+
+  if (frames <= 0 || sessions.empty())
+  {
+    return true;
+  }
+  double seconds =
+    std::chrono::duration<double>(Clock::now() - start).count();
+  int lowest = sessions.front()->currentScore();
+  int highest = lowest;
+  long total = 0;
+  for (const auto& session : sessions)
+  {
+    lowest = std::min(lowest, session->currentScore());
+    highest = std::max(highest, session->currentScore());
+    total += session->currentScore();
+  }
+  LOG_INFO("host: {} sessions x {} frames on {} workers, {} frames/s",
+           sessions.size(),
+           frames,
+           workers,
+           static_cast<double>(sessions.size()) * frames / seconds);
+  LOG_INFO("host: scores {} lowest, {} mean, {} highest",
+           lowest,
+           static_cast<double>(total) / static_cast<double>(sessions.size()),
+           highest);
+
+  if (options.alloc_budget < 0)
+  {
+    return true;
+  }
+  if (!AllocTracker::instrumented())
+  {
+    LOG_ERROR("host: allocation budget needs a TRACK_ALLOCATIONS build");
+    return false;
+  }
+  long over_budget = std::count_if(
+    sessions.begin(), sessions.end(), [](const auto& session) {
+      return !session->withinAllocationBudget();
+    });
+  if (over_budget > 0)
+  {
+    LOG_ERROR("host: {} of {} sessions went over the allocation budget",
+              over_budget,
+              sessions.size());
+    return false;
+  }
+  return true;
+}
+
+void SessionHost::workerLoop(int worker)
+{
+  TraceRecorder::nameThread("host worker");
+  int seen = 0;
+  for (;;)
+  {
+    int first = 0;
+    int count = 0;
+    {
+      std::unique_lock<std::mutex> lock(batch_mutex);
+      batch_ready.wait(lock,
+                       [this, seen] { return stopping || batch != seen; });
+      if (stopping)
+      {
+        return;
+      }
+      seen = batch;
+      first = batch_first;
+      count = batch_frames;
+    }
+    runSessions(worker, first, count);
+    {
+      std::lock_guard<std::mutex> lock(batch_mutex);
+      workers_busy--;
+    }
+    batch_done.notify_one();
+  }
+}
+
+/**
+ *   @brief   Runs one worker's share of a batch
+ *   @details Worker w owns sessions w, w + workers and so on, for the
+ *            whole run, so a session is only ever touched by one
+ *            thread at a time.
+ */
+
+void SessionHost::runSessions(int worker, int first_frame, int frame_count)
+{
+  TRACE_SCOPE("hostBatch", "host");
+  for (auto i = static_cast<size_t>(worker); i < sessions.size();
+       i += static_cast<size_t>(workers))
+  {
+    ASGE::GameTime game_time;
+    game_time.delta = std::chrono::duration<double, std::milli>(FRAME_MS);
+    for (int frame = first_frame; frame < first_frame + frame_count; frame++)
+    {
+      game_time.elapsed = std::chrono::milliseconds(frame * FRAME_MS);
+      sessions[i]->stepHeadless(frame, game_time);
+    }
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "asset_store.h"
+#include "game.h"
+#include "telemetry_writer.h"
+#include "tuning_watcher.h"
+
+/**
+ *  Runs many independent headless games in one process.
+ *  Each session has its own fish, random numbers, score and mode and
+ *  simulates inline; the host spreads the sessions over a few worker
+ *  threads, which live as long as the host. Decoded assets and the
+ *  tuning set are loaded once and shared, read only, by every session,
+ *  and one writer thread does the telemetry files of them all. Every
+ *  session is configured with the host's options.
+ */
+class SessionHost
+{
+ public:
+  enum
+  {
+    FRAME_MS = 16,
+    FRAMES_PER_BATCH = 60 /**< Frames between tuning reloads. */
+  };
+
+  SessionHost(int session_count,
+              int worker_count,
+              const GameOptions& game_options);
+  ~SessionHost();
+  SessionHost(const SessionHost&) = delete;
+  SessionHost& operator=(const SessionHost&) = delete;
+
+  bool init();
+  bool run(int frames);
+
+ private:
+  void workerLoop(int worker);
+  void runSessions(int worker, int first_frame, int frame_count);
+
+  GameOptions options;
+  AssetStore assets;
+  TuningWatcher tuning_watcher;
+  std::shared_ptr<const TuningSet> tuning;
+  TelemetryWriter telemetry_writer; /**< Outlives every session. */
+  std::vector<std::unique_ptr<MyASGEGame>> sessions;
+  int workers = 1;
+
+  std::mutex batch_mutex;
+  std::condition_variable batch_ready;
+  std::condition_variable batch_done;
+  int batch = 0; /**< Counts the batches handed to the workers. */
+  int batch_first = 0;
+  int batch_frames = 0;
+  int workers_busy = 0;
+  bool stopping = false;
+  std::vector<std::thread> threads;
+};
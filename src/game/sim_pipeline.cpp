@@ -0,0 +1,94 @@
+#include <utility>
+
+#include "sim_pipeline.h"
+#include "trace_recorder.h"
+
+SimPipeline::~SimPipeline()
+{
+  stop();
+}
+
+/**
+ *   @brief   Sets the tick to run and starts the worker
+ *   @param   tick Simulates one frame. Runs on the worker when threaded.
+ *   @param   threaded False runs every tick inline on kick().
+ */
+
+void SimPipeline::start(std::function<void()> tick, bool threaded)
+{
+  stop();
+  tick_function = std::move(tick);
+  stopping = false;
+  if (threaded)
+  {
+    worker = std::thread(&SimPipeline::workerLoop, this);
+  }
+}
+
+/**
+ *   @brief   Finishes the tick in flight and joins the worker
+ */
+
+void SimPipeline::stop()
+{
+  if (!worker.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  signal.notify_all();
+  worker.join();
+}
+
+/**
+ *   @brief   Hands the next tick to the worker
+ *   @details Waits for the previous tick first, so a missing wait()
+ *            costs a stall rather than two ticks at once.
+ */
+
+void SimPipeline::kick()
+{
+  if (!worker.joinable())
+  {
+    tick_function();
+    return;
+  }
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = true;
+  }
+  signal.notify_all();
+}
+
+void SimPipeline::wait()
+{
+  if (!worker.joinable())
+  {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  signal.wait(lock, [this] { return !pending; });
+}
+
+void SimPipeline::workerLoop()
+{
+  TraceRecorder::nameThread("simulation");
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;)
+  {
+    signal.wait(lock, [this] { return pending || stopping; });
+    if (!pending)
+    {
+      break;
+    }
+    lock.unlock();
+    tick_function();
+    lock.lock();
+    pending = false;
+    signal.notify_all();
+  }
+}
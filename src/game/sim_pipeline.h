@@ -0,0 +1,37 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ *  Runs the simulation tick on a worker thread, one tick at a time.
+ *  kick() hands the worker the next tick and wait() blocks until it is
+ *  done, so at most one tick is ever in flight and the caller owns the
+ *  game state whenever it is not between the two. Started unthreaded,
+ *  kick() runs the tick inline instead.
+ */
+class SimPipeline
+{
+ public:
+  SimPipeline() = default;
+  ~SimPipeline();
+  SimPipeline(const SimPipeline&) = delete;
+  SimPipeline& operator=(const SimPipeline&) = delete;
+
+  void start(std::function<void()> tick, bool threaded);
+  void stop();
+  void kick();
+  void wait();
+  bool threaded() const { return worker.joinable(); }
+
+ private:
+  void workerLoop();
+
+  std::function<void()> tick_function;
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable signal;
+  bool pending = false; /**< A tick was kicked and has not finished. */
+  bool stopping = false;
+};
@@ -0,0 +1,98 @@
+#include <algorithm>
+
+#include <Engine/Renderer.h>
+#include <Engine/Sprite.h>
+#include <Engine/Texture.h>
+
+#include "sprite_arena.h"
+
+SpriteArena::SpriteArena(int capacity) : limit(capacity)
+{
+  sprites.reserve(static_cast<size_t>(capacity));
+}
+
+SpriteArena::~SpriteArena()
+{
+  clear();
+}
+
+/**
+ *   @brief   Creates a sprite owned by the arena
+ *   @details The storage is reserved up front, so creating a sprite
+ *            never moves the others.
+ *   @return  The new sprite, or nullptr once the arena is full.
+ */
+
+ASGE::Sprite* SpriteArena::create(ASGE::Renderer& renderer)
+{
+  if (size() >= limit)
+  {
+    return nullptr;
+  }
+  sprites.push_back(renderer.createUniqueSprite());
+  return sprites.back().get();
+}
+
+/**
+ *   @brief   Destroys every sprite, newest first
+ *   @details Must run while the renderer that made them is alive.
+ */
+
+void SpriteArena::clear()
+{
+  while (!sprites.empty())
+  {
+    sprites.pop_back();
+  }
+}
+
+/**
+ *   @brief   The memory held by the sprite objects
+ *   @details Counted as ASGE::Sprite, whatever a backend adds on top
+ *            of that is not visible from here.
+ */
+
+size_t SpriteArena::spriteBytes() const
+{
+  return sprites.capacity() * sizeof(std::unique_ptr<ASGE::Sprite>) +
+         sprites.size() * sizeof(ASGE::Sprite);
+}
+
+std::vector<const ASGE::Texture2D*> SpriteArena::uniqueTextures() const
+{
+  std::vector<const ASGE::Texture2D*> textures;
+  textures.reserve(sprites.size());
+  for (const auto& sprite : sprites)
+  {
+    if (sprite->getTexture() != nullptr)
+    {
+      textures.push_back(sprite->getTexture());
+    }
+  }
+  std::sort(textures.begin(), textures.end());
+  textures.erase(std::unique(textures.begin(), textures.end()),
+                 textures.end());
+  return textures;
+}
+
+/**
+ *   @brief   The pixel memory of the textures the sprites use
+ *   @details Sprites sharing a texture count it once. The size is
+ *            width * height * channels of the loaded image.
+ */
+
+size_t SpriteArena::textureBytes() const
+{
+  size_t bytes = 0;
+  for (const ASGE::Texture2D* texture : uniqueTextures())
+  {
+    bytes += static_cast<size_t>(texture->getWidth()) * texture->getHeight() *
+             static_cast<size_t>(texture->getFormat());
+  }
+  return bytes;
+}
+
+int SpriteArena::textureCount() const
+{
+  return static_cast<int>(uniqueTextures().size());
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ASGE
+{
+  class Renderer;
+  class Sprite;
+  class Texture2D;
+}
+
+/**
+ *  Owns every sprite of a game session. The sprites are allocated one
+ *  by one, the table owning them is reserved up front so it never
+ *  grows, and creating more than the capacity fails. Sprites are
+ *  handed out as plain pointers that stay valid until clear(), which
+ *  destroys them all together, so nothing created through the arena
+ *  outlives it or leaks between sessions.
+ */
+class SpriteArena
+{
+ public:
+  explicit SpriteArena(int capacity);
+  ~SpriteArena();
+  SpriteArena(const SpriteArena&) = delete;
+  SpriteArena& operator=(const SpriteArena&) = delete;
+
+  ASGE::Sprite* create(ASGE::Renderer& renderer);
+  void clear();
+
+  int size() const { return static_cast<int>(sprites.size()); }
+  int capacity() const { return limit; }
+  size_t spriteBytes() const;
+  size_t textureBytes() const;
+  int textureCount() const;
+
+ private:
+  std::vector<const ASGE::Texture2D*> uniqueTextures() const;
+
+  std::vector<std::unique_ptr<ASGE::Sprite>> sprites;
+  int limit = 0;
+};
@@ -0,0 +1,187 @@
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define NEMO_HAS_SHM 1
+#endif
+
+#include "logger.h"
+#include "state_export.h"
+
+StateExport::~StateExport()
+{
+  close();
+}
+
+/**
+ *   @brief   Creates the shared memory object and maps it
+ *   @details An existing object is only reused when it is marked dead,
+ *            which is what a game that exited between clearing alive
+ *            and removing the name leaves behind. One a running game
+ *            owns, or one a crashed game left marked alive, is left
+ *            alone and open fails; remove it or pick another name.
+ *            The block is claimed by moving alive from 0 to 1, so of
+ *            two games starting at once only one gets it, then cleared
+ *            before the first frame is written.
+ *   @param   name A POSIX shared memory name, such as "/nemo-live".
+ *   @return  false if the object could not be created, claimed or
+ *            mapped.
+ */
+
+bool StateExport::open(const std::string& name)
+{
+  close();
+#ifdef NEMO_HAS_SHM
+  int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  bool created = descriptor >= 0;
+  if (!created && errno == EEXIST)
+  {
+    descriptor = shm_open(name.c_str(), O_RDWR, 0644);
+  }
+  if (descriptor < 0)
+  {
+    LOG_WARN("export::Failed to create {}", name);
+    return false;
+  }
+  if (!created)
+  {
+    // empty when its creator has not sized it yet
+    struct stat status = {};
+    if (fstat(descriptor, &status) != 0 ||
+        (status.st_size != 0 &&
+         status.st_size != static_cast<off_t>(sizeof(StateExportBlock))))
+    {
+      LOG_WARN("export::{} exists and is not a live state block", name);
+      ::close(descriptor);
+      return false;
+    }
+  }
+  void* mapping = MAP_FAILED;
+  if (ftruncate(descriptor, sizeof(StateExportBlock)) == 0)
+  {
+    mapping = mmap(nullptr,
+                   sizeof(StateExportBlock),
+                   PROT_READ | PROT_WRITE,
+                   MAP_SHARED,
+                   descriptor,
+                   0);
+  }
+  ::close(descriptor);
+  if (mapping == MAP_FAILED)
+  {
+    LOG_WARN("export::Failed to map {}", name);
+    if (created)
+    {
+      shm_unlink(name.c_str());
+    }
+    return false;
+  }
+
+  // a new object is all zeroes, so it is claimed the same way
+  auto* claimed = static_cast<StateExportBlock*>(mapping);
+  std::uint32_t dead = 0;
+  if (!claimed->alive.compare_exchange_strong(dead, 1))
+  {
+    LOG_WARN("export::{} is in use by a running game", name);
+    munmap(mapping, sizeof(StateExportBlock));
+    return false;
+  }
+
+  // cleared around alive, which now marks the block as ours
+  block = claimed;
+  auto* bytes = static_cast<char*>(mapping);
+  auto header = static_cast<size_t>(reinterpret_cast<char*>(&block->frame) -
+                                    bytes);
+  std::memset(&block->frame, 0, sizeof(StateExportBlock) - header);
+  std::memcpy(block->magic, STATE_EXPORT_MAGIC, sizeof(block->magic));
+  block->version = STATE_EXPORT_VERSION;
+  block->block_size = sizeof(StateExportBlock);
+  block->sequence.store(0, std::memory_order_release);
+  shm_name = name;
+  sequence = 0;
+  LOG_INFO(
+    "export::Live state in {}, {} bytes", name, sizeof(StateExportBlock));
+  return true;
+#else
+  LOG_WARN("export::Shared memory is not available, {} not created", name);
+  return false;
+#endif
+}
+
+/**
+ *   @brief   Marks the block dead, unmaps it and removes the name
+ *   @details Readers that are still attached keep their mapping and
+ *            see alive drop to zero.
+ */
+
+void StateExport::close()
+{
+#ifdef NEMO_HAS_SHM
+  if (block == nullptr)
+  {
+    return;
+  }
+  block->alive.store(0, std::memory_order_release);
+  munmap(block, sizeof(StateExportBlock));
+  shm_unlink(shm_name.c_str());
+  block = nullptr;
+#endif
+}
+
+/**
+ *   @brief   Opens the block for this frame's state
+ *   @details Makes the sequence odd, then fills in the frame counters
+ *            and timing. The caller writes the game state and calls
+ *            endWrite.
+ *   @param   frame_ms How long the frame took.
+ *   @return  nullptr when nothing is being exported.
+ */
+
+StateExportBlock* StateExport::beginWrite(double frame_ms)
+{
+  if (block == nullptr)
+  {
+    return nullptr;
+  }
+
+  window_ms += frame_ms;
+  window_frames++;
+  if (frame_ms > window_worst_ms)
+  {
+    window_worst_ms = frame_ms;
+  }
+  if (window_ms >= STATS_WINDOW_MS || !window_full)
+  {
+    mean_ms = static_cast<float>(window_ms / window_frames);
+    worst_ms = static_cast<float>(window_worst_ms);
+  }
+  if (window_ms >= STATS_WINDOW_MS)
+  {
+    window_full = true;
+    window_ms = 0;
+    window_worst_ms = 0;
+    window_frames = 0;
+  }
+
+  block->sequence.store(++sequence, std::memory_order_relaxed);
+  // keeps the payload stores below from moving above the odd sequence
+  std::atomic_thread_fence(std::memory_order_release);
+  block->frame = ++frame;
+  block->frame_ms = static_cast<float>(frame_ms);
+  block->frame_ms_mean = mean_ms;
+  block->frame_ms_worst = worst_ms;
+  return block;
+}
+
+/**
+ *   @brief   Publishes what was written since beginWrite
+ */
+
+void StateExport::endWrite()
+{
+  block->sequence.store(++sequence, std::memory_order_release);
+}
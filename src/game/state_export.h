@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "state_export_format.h"
+
+/**
+ *  Publishes the game's live state in a POSIX shared memory object
+ *  for overlays and monitors on the same machine. The game writes the
+ *  block in place once a frame under a sequence lock, so publishing
+ *  is a handful of stores and readers never hold the game up. On
+ *  platforms without shm_open, open fails and nothing is exported.
+ */
+class StateExport
+{
+ public:
+  enum
+  {
+    STATS_WINDOW_MS = 1000
+  };
+
+  StateExport() = default;
+  ~StateExport();
+  StateExport(const StateExport&) = delete;
+  StateExport& operator=(const StateExport&) = delete;
+
+  bool open(const std::string& name);
+  void close();
+  bool exporting() const { return block != nullptr; }
+
+  StateExportBlock* beginWrite(double frame_ms);
+  void endWrite();
+
+ private:
+  StateExportBlock* block = nullptr;
+  std::string shm_name;
+  std::uint32_t sequence = 0;
+  std::uint64_t frame = 0;
+  double window_ms = 0;
+  double window_worst_ms = 0;
+  int window_frames = 0;
+  bool window_full = false; /**< Until then the running window is shown. */
+  float mean_ms = 0;
+  float worst_ms = 0;
+};
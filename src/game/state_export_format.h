@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ *  The layout of the live state the game exports to shared memory,
+ *  shared by the game and the state reader. Both sides map the same
+ *  pages on one machine, so the block is in native byte order.
+ *
+ *  The block is guarded by a sequence lock. sequence is odd while the
+ *  game is writing; a reader notes it, reads what it wants straight
+ *  from the mapping and checks it again afterwards. If it was odd or
+ *  has moved on, what was read may be torn and is read again. The
+ *  game never waits for a reader.
+ */
+enum StateExportLayout
+{
+  STATE_EXPORT_VERSION = 1,
+  STATE_EXPORT_MAX_FISH = 2048
+};
+
+const char STATE_EXPORT_MAGIC[8] = { 'N', 'E', 'M', 'O', 'L', 'I', 'V', 'E' };
+const char* const STATE_EXPORT_DEFAULT_NAME = "/nemo-live";
+
+/**
+ *  A fish as it was drawn, in whole pixels.
+ */
+struct StateExportFish
+{
+  std::int16_t x;
+  std::int16_t y;
+  std::uint16_t size;
+  std::uint8_t type;
+  std::uint8_t visible;
+};
+
+/**
+ *  Everything in the shared memory object. The atomics are lock free
+ *  on every platform the game runs on, which makes them usable across
+ *  processes.
+ */
+struct StateExportBlock
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t block_size; /**< Catches a reader built for another layout. */
+  std::atomic<std::uint32_t> sequence;
+  std::atomic<std::uint32_t> alive; /**< Cleared when the game exits. */
+
+  std::uint64_t frame;
+  std::int32_t score;
+  float life;
+  std::int32_t difficulty_state;
+  std::int32_t game_mode; /**< 0 standard, 1 arcade, 2 endless. */
+  std::int32_t in_menu;
+  std::int32_t fish_count; /**< Entries of fish in use. */
+  float frame_ms;          /**< The last frame. */
+  float frame_ms_mean;     /**< Over the last full window. */
+  float frame_ms_worst;    /**< Over the last full window. */
+  StateExportFish fish[STATE_EXPORT_MAX_FISH];
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/**
+ *  The on-disk layout of a gameplay telemetry file, shared by the game
+ *  and the offline analyzer. A file is one header followed by fixed
+ *  size records, all little endian, so it can be walked in place.
+ */
+enum TelemetryLayout
+{
+  TELEMETRY_VERSION = 1,
+  TELEMETRY_HEADER_SIZE = 16,
+  TELEMETRY_RECORD_SIZE = 16
+};
+
+const char TELEMETRY_MAGIC[8] = { 'N', 'E', 'M', 'O', 'T', 'E', 'L', 'M' };
+
+enum TelemetryKind
+{
+  TELEMETRY_CLICK = 1,      /**< x, y; detail = fish caught by it. */
+  TELEMETRY_CATCH = 2,      /**< x, y; detail = type, value = score. */
+  TELEMETRY_DIFFICULTY = 3, /**< detail = new bracket, value = score. */
+  TELEMETRY_LIFE = 4,       /**< value = arcade life. */
+  TELEMETRY_FRAMES = 5,     /**< count frames, value = their total us,
+                                 x = the worst one in 0.1ms. */
+  TELEMETRY_END = 6         /**< detail = bracket, value = final score. */
+};
+
+/**
+ *  One event. time_ms counts from the start of the session.
+ */
+struct TelemetryRecord
+{
+  std::uint32_t time_ms = 0;
+  std::uint8_t kind = 0;
+  std::uint8_t detail = 0;
+  std::int16_t x = 0;
+  std::int16_t y = 0;
+  std::uint16_t count = 0;
+  std::int32_t value = 0;
+
+  void encode(unsigned char* out) const
+  {
+    put(out, time_ms, 4);
+    out[4] = kind;
+    out[5] = detail;
+    put(out + 6, static_cast<std::uint16_t>(x), 2);
+    put(out + 8, static_cast<std::uint16_t>(y), 2);
+    put(out + 10, count, 2);
+    put(out + 12, static_cast<std::uint32_t>(value), 4);
+  }
+
+  static TelemetryRecord decode(const unsigned char* in)
+  {
+    TelemetryRecord record;
+    record.time_ms = get(in, 4);
+    record.kind = in[4];
+    record.detail = in[5];
+    record.x = static_cast<std::int16_t>(get(in + 6, 2));
+    record.y = static_cast<std::int16_t>(get(in + 8, 2));
+    record.count = static_cast<std::uint16_t>(get(in + 10, 2));
+    record.value = static_cast<std::int32_t>(get(in + 12, 4));
+    return record;
+  }
+
+  static void put(unsigned char* out, std::uint32_t bits, int bytes)
+  {
+    for (int i = 0; i < bytes; i++)
+    {
+      out[i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+  }
+
+  static std::uint32_t get(const unsigned char* in, int bytes)
+  {
+    std::uint32_t bits = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+      bits |= static_cast<std::uint32_t>(in[i]) << (8 * i);
+    }
+    return bits;
+  }
+};
+
+/**
+ *  The file header: magic, version, game mode and the session start as
+ *  seconds since the unix epoch.
+ */
+struct TelemetryHeader
+{
+  std::uint16_t version = TELEMETRY_VERSION;
+  std::uint16_t game_mode = 0;
+  std::uint32_t start_time = 0;
+
+  void encode(unsigned char* out) const
+  {
+    std::memcpy(out, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+    TelemetryRecord::put(out + 8, version, 2);
+    TelemetryRecord::put(out + 10, game_mode, 2);
+    TelemetryRecord::put(out + 12, start_time, 4);
+  }
+
+  static bool decode(const unsigned char* in, TelemetryHeader& header)
+  {
+    if (std::memcmp(in, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC)) != 0)
+    {
+      return false;
+    }
+    header.version =
+      static_cast<std::uint16_t>(TelemetryRecord::get(in + 8, 2));
+    header.game_mode =
+      static_cast<std::uint16_t>(TelemetryRecord::get(in + 10, 2));
+    header.start_time = TelemetryRecord::get(in + 12, 4);
+    return header.version == TELEMETRY_VERSION;
+  }
+};
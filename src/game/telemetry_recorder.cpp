@@ -0,0 +1,325 @@
+#include <cstdio>
+#include <utility>
+
+#include "telemetry_recorder.h"
+
+std::atomic<int> TelemetryRecorder::session_index{ 0 };
+
+namespace
+{
+  std::int16_t coordinate(float position)
+  {
+    if (position < -32768.0f)
+    {
+      return -32768;
+    }
+    if (position > 32767.0f)
+    {
+      return 32767;
+    }
+    return static_cast<std::int16_t>(position);
+  }
+}
+
+TelemetryRecorder::TelemetryRecorder()
+{
+  batch.reserve(BATCH_RECORDS * TELEMETRY_RECORD_SIZE);
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+  stop();
+}
+
+/**
+ *   @brief   Waits for everything queued to be written
+ *   @details Stops the writer too if it is the recorder's own. Nothing
+ *            is recorded after this. Safe to call twice.
+ */
+
+void TelemetryRecorder::stop()
+{
+  stopped = true;
+  active = false;
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    drained.wait(lock, [this] { return pending_jobs == 0; });
+  }
+  own_writer.reset();
+  writer = nullptr;
+}
+
+/**
+ *   @brief   Makes the recorder queue its files on a shared writer
+ *   @details Set before the first session. The writer must outlive
+ *            the recorder, or at least its stop.
+ */
+
+void TelemetryRecorder::shareWriter(TelemetryWriter* shared)
+{
+  writer = shared;
+}
+
+/**
+ *   @brief   Starts a new telemetry file
+ *   @details The file is named after the wall clock start time and the
+ *            session number, so sessions never overwrite each other.
+ *   @param   game_mode 0 for the standard game, 1 for arcade.
+ */
+
+void TelemetryRecorder::beginSession(int game_mode)
+{
+  if (active || stopped)
+  {
+    return;
+  }
+  if (writer == nullptr)
+  {
+    own_writer = std::make_unique<TelemetryWriter>();
+    writer = own_writer.get();
+  }
+  active = true;
+  session_start = Clock::now();
+  last_flush_ms = 0;
+  last_life_ms = 0;
+  frame_window_ms = 0;
+  window_frames = 0;
+  window_us = 0;
+  window_worst_us = 0;
+
+  auto wall_clock = std::chrono::system_clock::now().time_since_epoch();
+  TelemetryHeader header;
+  header.game_mode = static_cast<std::uint16_t>(game_mode);
+  header.start_time = static_cast<std::uint32_t>(
+    std::chrono::duration_cast<std::chrono::seconds>(wall_clock).count());
+
+  char name[64];
+  std::snprintf(
+    name,
+    sizeof(name),
+    "telemetry/%lld-%d.ntl",
+    static_cast<long long>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(wall_clock)
+        .count()),
+    session_index++);
+
+  Job open = { Job::OPEN, this, name, std::vector<unsigned char>() };
+  open.bytes.resize(TELEMETRY_HEADER_SIZE);
+  header.encode(open.bytes.data());
+  enqueue(std::move(open));
+}
+
+/**
+ *   @brief   Writes the last events of the session and closes its file
+ *   @param   final_score The score the session ended on.
+ *   @param   bracket The difficulty bracket it reached.
+ */
+
+void TelemetryRecorder::endSession(int final_score, int bracket)
+{
+  if (!active)
+  {
+    return;
+  }
+  if (window_frames > 0)
+  {
+    frame(0);
+  }
+  TelemetryRecord record;
+  record.kind = TELEMETRY_END;
+  record.detail = static_cast<std::uint8_t>(bracket);
+  record.value = final_score;
+  push(record);
+  submit();
+  enqueue(
+    { Job::CLOSE, this, std::string(), std::vector<unsigned char>() });
+  active = false;
+}
+
+void TelemetryRecorder::click(float x, float y, int caught_fish)
+{
+  TelemetryRecord record;
+  record.kind = TELEMETRY_CLICK;
+  record.detail = static_cast<std::uint8_t>(caught_fish);
+  record.x = coordinate(x);
+  record.y = coordinate(y);
+  push(record);
+}
+
+void TelemetryRecorder::caught(int type, int score_value, float x, float y)
+{
+  TelemetryRecord record;
+  record.kind = TELEMETRY_CATCH;
+  record.detail = static_cast<std::uint8_t>(type);
+  record.x = coordinate(x);
+  record.y = coordinate(y);
+  record.value = score_value;
+  push(record);
+}
+
+void TelemetryRecorder::difficulty(int bracket, int score)
+{
+  TelemetryRecord record;
+  record.kind = TELEMETRY_DIFFICULTY;
+  record.detail = static_cast<std::uint8_t>(bracket);
+  record.value = score;
+  push(record);
+}
+
+/**
+ *   @brief   Samples the arcade life
+ *   @details Called every frame, but only one sample per LIFE_SAMPLE_MS
+ *            is kept.
+ */
+
+void TelemetryRecorder::life(float value)
+{
+  if (!active || sessionMillis() - last_life_ms < LIFE_SAMPLE_MS)
+  {
+    return;
+  }
+  last_life_ms = sessionMillis();
+  TelemetryRecord record;
+  record.kind = TELEMETRY_LIFE;
+  record.value = static_cast<std::int32_t>(value);
+  push(record);
+}
+
+/**
+ *   @brief   Accumulates frame times and flushes on a timer
+ *   @details Frames are summarised once per FRAME_WINDOW_MS rather than
+ *            written one by one. This is also where a part filled batch
+ *            is handed to the writer every FLUSH_INTERVAL_MS.
+ *   @param   frame_ms The length of the frame, 0 only closes the window.
+ */
+
+void TelemetryRecorder::frame(double frame_ms)
+{
+  if (!active)
+  {
+    return;
+  }
+  if (frame_ms > 0)
+  {
+    window_frames++;
+    window_us += frame_ms * 1000.0;
+    if (frame_ms * 1000.0 > window_worst_us)
+    {
+      window_worst_us = frame_ms * 1000.0;
+    }
+  }
+
+  std::uint32_t now = sessionMillis();
+  if (now - frame_window_ms >= FRAME_WINDOW_MS || frame_ms <= 0)
+  {
+    TelemetryRecord record;
+    record.kind = TELEMETRY_FRAMES;
+    record.count = window_frames;
+    record.value = static_cast<std::int32_t>(window_us);
+    record.x = coordinate(static_cast<float>(window_worst_us / 100.0));
+    push(record);
+    frame_window_ms = now;
+    window_frames = 0;
+    window_us = 0;
+    window_worst_us = 0;
+  }
+  if (now - last_flush_ms >= FLUSH_INTERVAL_MS)
+  {
+    last_flush_ms = now;
+    submit();
+  }
+}
+
+std::uint32_t TelemetryRecorder::sessionMillis() const
+{
+  return static_cast<std::uint32_t>(
+    std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                          session_start)
+      .count());
+}
+
+/**
+ *   @brief   Encodes a record into the current batch
+ *   @details The batch has its full size reserved, so appending never
+ *            allocates. A full batch is submitted straight away.
+ */
+
+void TelemetryRecorder::push(TelemetryRecord& record)
+{
+  if (!active)
+  {
+    return;
+  }
+  record.time_ms = sessionMillis();
+  size_t end = batch.size();
+  batch.resize(end + TELEMETRY_RECORD_SIZE);
+  record.encode(batch.data() + end);
+  if (batch.size() >= batch.capacity())
+  {
+    submit();
+  }
+}
+
+/**
+ *   @brief   Hands the current batch to the writer thread
+ *   @details Swaps in a recycled buffer. When MAX_QUEUED_BATCHES are
+ *            already waiting the batch is dropped and counted instead.
+ */
+
+void TelemetryRecorder::submit()
+{
+  if (batch.empty())
+  {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  if (queued_batches >= MAX_QUEUED_BATCHES)
+  {
+    dropped += static_cast<long>(batch.size() / TELEMETRY_RECORD_SIZE);
+    batch.clear();
+    return;
+  }
+  queued_batches++;
+  pending_jobs++;
+  Job write = { Job::WRITE, this, std::string(), std::move(batch) };
+  if (spare_buffers.empty())
+  {
+    batch = std::vector<unsigned char>();
+  }
+  else
+  {
+    batch = std::move(spare_buffers.back());
+    spare_buffers.pop_back();
+  }
+  lock.unlock();
+  writer->enqueue(std::move(write));
+  batch.reserve(BATCH_RECORDS * TELEMETRY_RECORD_SIZE);
+}
+
+void TelemetryRecorder::enqueue(Job&& job)
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    pending_jobs++;
+  }
+  writer->enqueue(std::move(job));
+}
+
+/**
+ *   @brief   Takes a job back from the writer once it is done
+ *   @details Runs on the writer thread. Written buffers go on the
+ *            spare list, and stop is woken when nothing is pending.
+ */
+
+void TelemetryRecorder::finished(Job& job)
+{
+  std::lock_guard<std::mutex> lock(queue_mutex);
+  if (job.action == Job::WRITE)
+  {
+    queued_batches--;
+    job.bytes.clear();
+    spare_buffers.push_back(std::move(job.bytes));
+  }
+  pending_jobs--;
+  drained.notify_all();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "telemetry_format.h"
+#include "telemetry_writer.h"
+
+/**
+ *  Streams the gameplay events of each session to its own file in the
+ *  write directory. Events are encoded into a batch on the game thread;
+ *  full batches are handed to a writer thread, which does all of the
+ *  file I/O. The game thread only ever takes the queue lock to swap a
+ *  buffer, and if the writer falls behind batches are dropped rather
+ *  than waited on. A game starts its own writer with its first
+ *  session; hosted games share the host's.
+ */
+class TelemetryRecorder
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum
+  {
+    BATCH_RECORDS = 512,
+    MAX_QUEUED_BATCHES = 8,
+    FLUSH_INTERVAL_MS = 1000,
+    LIFE_SAMPLE_MS = 250,
+    FRAME_WINDOW_MS = 1000
+  };
+
+  TelemetryRecorder();
+  ~TelemetryRecorder();
+  TelemetryRecorder(const TelemetryRecorder&) = delete;
+  TelemetryRecorder& operator=(const TelemetryRecorder&) = delete;
+
+  void shareWriter(TelemetryWriter* shared);
+  void beginSession(int game_mode);
+  void endSession(int final_score, int bracket);
+  void stop();
+  bool recording() const { return active; }
+
+  void click(float x, float y, int caught);
+  void caught(int type, int score_value, float x, float y);
+  void difficulty(int bracket, int score);
+  void life(float value);
+  void frame(double frame_ms);
+
+  long droppedRecords() const { return dropped; }
+
+ private:
+  friend class TelemetryWriter;
+  using Job = TelemetryWriter::Job;
+
+  std::uint32_t sessionMillis() const;
+  void push(TelemetryRecord& record);
+  void submit();
+  void enqueue(Job&& job);
+  void finished(Job& job);
+
+  bool active = false;
+  bool stopped = false;
+  static std::atomic<int> session_index; /**< Shared by hosted games. */
+  Clock::time_point session_start;
+  std::vector<unsigned char> batch;
+  std::uint32_t last_flush_ms = 0;
+  std::uint32_t last_life_ms = 0;
+  std::uint32_t frame_window_ms = 0;
+  std::uint16_t window_frames = 0;
+  double window_us = 0;
+  double window_worst_us = 0;
+  long dropped = 0;
+
+  TelemetryWriter* writer = nullptr;
+  std::unique_ptr<TelemetryWriter> own_writer; /**< When not shared. */
+
+  std::mutex queue_mutex;
+  std::condition_variable drained;
+  int queued_batches = 0; /**< Guarded by queue_mutex. */
+  int pending_jobs = 0;   /**< Ditto, queued and not yet finished. */
+  std::vector<std::vector<unsigned char>> spare_buffers; /**< Ditto. */
+};
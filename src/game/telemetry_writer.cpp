@@ -0,0 +1,116 @@
+#include <map>
+#include <memory>
+#include <utility>
+
+#include <Engine/FileIO.h>
+
+#include "logger.h"
+#include "telemetry_recorder.h"
+#include "telemetry_writer.h"
+#include "trace_recorder.h"
+
+TelemetryWriter::TelemetryWriter()
+{
+  writer = std::thread(&TelemetryWriter::writerLoop, this);
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+  stop();
+}
+
+/**
+ *   @brief   Writes everything queued and stops the thread
+ *   @details Safe to call twice. Recorders sharing the writer must be
+ *            stopped first.
+ */
+
+void TelemetryWriter::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stopping = true;
+  }
+  queue_signal.notify_one();
+  if (writer.joinable())
+  {
+    writer.join();
+  }
+}
+
+void TelemetryWriter::enqueue(Job&& job)
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    queue.push_back(std::move(job));
+  }
+  queue_signal.notify_one();
+}
+
+/**
+ *   @brief   The writer thread
+ *   @details Runs the queued jobs in order, outside of the lock, then
+ *            returns each to its recorder. Pending jobs are still
+ *            written when the writer is stopped.
+ */
+
+void TelemetryWriter::writerLoop()
+{
+  TraceRecorder::nameThread("telemetry writer");
+  std::map<const TelemetryRecorder*, std::unique_ptr<ASGE::FILEIO::File>>
+    files;
+  for (;;)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_signal.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (queue.empty())
+      {
+        break;
+      }
+      job = std::move(queue.front());
+      queue.pop_front();
+    }
+
+    TRACE_SCOPE("telemetryJob", "telemetry");
+    auto open = files.find(job.owner);
+    if (job.action == Job::OPEN)
+    {
+      if (open != files.end())
+      {
+        open->second->close();
+        files.erase(open);
+        open = files.end();
+      }
+      ASGE::FILEIO::createDir("telemetry");
+      auto file = std::make_unique<ASGE::FILEIO::File>();
+      if (file->open(job.file_name, ASGE::FILEIO::File::IOMode::WRITE))
+      {
+        open = files.emplace(job.owner, std::move(file)).first;
+      }
+      else
+      {
+        LOG_WARN("telemetry::Failed to open {}", job.file_name);
+      }
+    }
+    if (open != files.end() && job.action != Job::CLOSE)
+    {
+      ASGE::FILEIO::IOBuffer buffer;
+      buffer.append(reinterpret_cast<const char*>(job.bytes.data()),
+                    job.bytes.size());
+      open->second->write(buffer);
+    }
+    if (open != files.end() && job.action == Job::CLOSE)
+    {
+      open->second->close();
+      files.erase(open);
+    }
+
+    job.owner->finished(job);
+  }
+  for (auto& file : files)
+  {
+    file.second->close();
+  }
+}
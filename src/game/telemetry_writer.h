@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TelemetryRecorder;
+
+/**
+ *  Does the file I/O of any number of telemetry recorders on one
+ *  thread. Recorders queue jobs tagged with themselves; the writer
+ *  keeps a file open per recorder and hands every finished job back to
+ *  the recorder it came from, so written buffers are recycled and a
+ *  recorder can tell when all of its jobs are done.
+ */
+class TelemetryWriter
+{
+ public:
+  struct Job
+  {
+    enum Action
+    {
+      OPEN,
+      WRITE,
+      CLOSE
+    };
+    Action action;
+    TelemetryRecorder* owner;
+    std::string file_name;
+    std::vector<unsigned char> bytes;
+  };
+
+  TelemetryWriter();
+  ~TelemetryWriter();
+  TelemetryWriter(const TelemetryWriter&) = delete;
+  TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+  void enqueue(Job&& job);
+  void stop();
+
+ private:
+  void writerLoop();
+
+  std::mutex queue_mutex;
+  std::condition_variable queue_signal;
+  std::deque<Job> queue; /**< Guarded by queue_mutex. */
+  bool stopping = false; /**< Ditto. */
+  std::thread writer;
+};
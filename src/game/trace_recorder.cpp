@@ -0,0 +1,189 @@
+#include <cstdio>
+
+#include <Engine/FileIO.h>
+
+#include "trace_recorder.h"
+
+std::atomic<bool> TraceRecorder::recording{ false };
+std::atomic<unsigned> TraceRecorder::generation{ 0 };
+TraceRecorder::Clock::time_point TraceRecorder::epoch =
+  TraceRecorder::Clock::now();
+std::mutex TraceRecorder::registry_mutex;
+std::vector<std::unique_ptr<TraceRecorder::ThreadBuffer>>
+  TraceRecorder::buffers;
+
+namespace
+{
+  thread_local const char* local_thread_name = nullptr;
+}
+
+/**
+ *   @brief   Starts a new capture
+ *   @details Events from an earlier capture are discarded by each
+ *            thread the next time it records.
+ */
+
+void TraceRecorder::start()
+{
+  generation++;
+  recording = true;
+}
+
+/**
+ *   @brief   Ends the capture and writes it as Chrome trace JSON
+ *   @details Written to traces/<time>.json in the write directory.
+ *   @return  The file written, empty if nothing was.
+ */
+
+std::string TraceRecorder::stop()
+{
+  recording = false;
+
+  std::string json = "{\"traceEvents\":[\n";
+  char line[256];
+  bool first = true;
+  long dropped = 0;
+  unsigned capture = generation.load();
+  {
+    // owners reset their buffer only under the lock, so the events
+    // below the count read here stay put while they are written out
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& buffer : buffers)
+    {
+      if (buffer->generation.load() != capture)
+      {
+        continue;
+      }
+      dropped += buffer->dropped.load();
+      std::snprintf(line,
+                    sizeof(line),
+                    "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                    "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n",
+                    buffer->thread_id,
+                    buffer->thread_name != nullptr ? buffer->thread_name
+                                                   : "thread");
+      json += line;
+      first = false;
+
+      size_t count = buffer->count.load(std::memory_order_acquire);
+      for (size_t i = 0; i < count; i++)
+      {
+        const Event& event = buffer->events[i];
+        std::snprintf(line,
+                      sizeof(line),
+                      ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\","
+                      "\"ts\":%.3f,\"pid\":1,\"tid\":%d}",
+                      event.name,
+                      event.category,
+                      event.phase,
+                      static_cast<double>(event.time_ns) / 1000.0,
+                      buffer->thread_id);
+        json += line;
+      }
+    }
+  }
+  std::snprintf(line,
+                sizeof(line),
+                "\n],\"otherData\":{\"dropped_events\":%ld}}\n",
+                dropped);
+  json += line;
+  if (first)
+  {
+    return std::string();
+  }
+
+  char file_name[64];
+  std::snprintf(
+    file_name,
+    sizeof(file_name),
+    "traces/%lld.json",
+    static_cast<long long>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch())
+        .count()));
+  ASGE::FILEIO::createDir("traces");
+  ASGE::FILEIO::File file;
+  if (!file.open(file_name, ASGE::FILEIO::File::IOMode::WRITE))
+  {
+    return std::string();
+  }
+  ASGE::FILEIO::IOBuffer buffer;
+  buffer.append(json.data(), json.size());
+  file.write(buffer);
+  file.close();
+  return file_name;
+}
+
+void TraceRecorder::begin(const char* name, const char* category)
+{
+  record('B', name, category);
+}
+
+void TraceRecorder::end(const char* name, const char* category)
+{
+  record('E', name, category);
+}
+
+/**
+ *   @brief   Names the calling thread in the trace
+ *   @details Takes effect when the thread first records, so naming a
+ *            thread costs nothing while tracing is off.
+ */
+
+void TraceRecorder::nameThread(const char* name)
+{
+  local_thread_name = name;
+}
+
+/**
+ *   @brief   Appends an event to the calling thread's buffer
+ *   @details The count is published with release, so stop() reads
+ *            only complete events. The first event of a new capture
+ *            resets the buffer under the registry lock, which stop()
+ *            holds while it reads. A full buffer drops the event.
+ */
+
+void TraceRecorder::record(char phase, const char* name, const char* category)
+{
+  ThreadBuffer& buffer = localBuffer();
+  unsigned current = generation.load(std::memory_order_relaxed);
+  if (buffer.generation.load(std::memory_order_relaxed) != current)
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffer.count.store(0, std::memory_order_relaxed);
+    buffer.dropped = 0;
+    buffer.generation = current;
+  }
+  size_t slot = buffer.count.load(std::memory_order_relaxed);
+  if (slot >= buffer.events.size())
+  {
+    buffer.dropped++;
+    return;
+  }
+  buffer.events[slot] = {
+    name,
+    category,
+    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch)
+      .count(),
+    phase
+  };
+  buffer.count.store(slot + 1, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::localBuffer()
+{
+  thread_local ThreadBuffer* local = nullptr;
+  if (local == nullptr)
+  {
+    auto created = std::make_unique<ThreadBuffer>();
+    created->events.resize(EVENTS_PER_THREAD);
+    created->thread_name = local_thread_name;
+    created->generation = generation.load();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    created->thread_id = static_cast<int>(buffers.size()) + 1;
+    local = created.get();
+    buffers.push_back(std::move(created));
+  }
+  return *local;
+}
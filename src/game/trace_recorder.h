@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ *  Records begin/end spans for a Chrome trace (chrome://tracing or
+ *  Perfetto). It is always compiled in and off until start(); while off
+ *  a span costs one relaxed atomic load. Each thread appends to its own
+ *  fixed size buffer, so recording takes no lock and does not allocate
+ *  after a thread's first event. Span names are not copied, they must
+ *  be string literals or otherwise outlive the capture.
+ */
+class TraceRecorder
+{
+ public:
+  enum
+  {
+    EVENTS_PER_THREAD = 1 << 17
+  };
+
+  static bool enabled() { return recording.load(std::memory_order_relaxed); }
+  static void start();
+  static std::string stop();
+
+  static void begin(const char* name, const char* category);
+  static void end(const char* name, const char* category);
+  static void nameThread(const char* name);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Event
+  {
+    const char* name;
+    const char* category;
+    std::int64_t time_ns;
+    char phase;
+  };
+
+  struct ThreadBuffer
+  {
+    int thread_id = 0;
+    const char* thread_name = nullptr;
+    std::atomic<unsigned> generation{ 0 }; /**< Changed under the lock. */
+    std::vector<Event> events;
+    std::atomic<size_t> count{ 0 }; /**< Reset under the lock. */
+    std::atomic<long> dropped{ 0 };
+  };
+
+  static void record(char phase, const char* name, const char* category);
+  static ThreadBuffer& localBuffer();
+
+  static std::atomic<bool> recording;
+  static std::atomic<unsigned> generation;
+  static Clock::time_point epoch;
+  static std::mutex registry_mutex;
+  static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+/**
+ *  Records a span from construction to the end of the scope.
+ */
+class TraceSpan
+{
+ public:
+  TraceSpan(const char* span_name, const char* span_category) :
+    name(span_name), category(span_category), active(TraceRecorder::enabled())
+  {
+    if (active)
+    {
+      TraceRecorder::begin(name, category);
+    }
+  }
+  ~TraceSpan()
+  {
+    if (active)
+    {
+      TraceRecorder::end(name, category);
+    }
+  }
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+ private:
+  const char* name;
+  const char* category;
+  bool active;
+};
+
+#define TRACE_JOIN_LINE(prefix, line) prefix##line
+#define TRACE_SPAN_NAME(line) TRACE_JOIN_LINE(trace_span_, line)
+#define TRACE_SCOPE(name, category)                                            \
+  TraceSpan TRACE_SPAN_NAME(__LINE__)(name, category)
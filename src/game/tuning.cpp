@@ -0,0 +1,302 @@
+#include <nlohmann/json.hpp>
+
+#include "tuning.h"
+
+namespace
+{
+  using json = nlohmann::json;
+
+  /**
+   *   @brief   Reads an integer field if the object has it
+   *   @return  false if the field is there but not an integer.
+   */
+
+  bool readInt(const json& object,
+               const char* key,
+               int& value,
+               std::string& error)
+  {
+    auto field = object.find(key);
+    if (field == object.end())
+    {
+      return true;
+    }
+    if (!field->is_number_integer())
+    {
+      error = std::string(key) + " must be an integer";
+      return false;
+    }
+    value = field->get<int>();
+    return true;
+  }
+
+  bool readInts(const json& field,
+                const std::string& name,
+                int* values,
+                int count,
+                std::string& error)
+  {
+    if (!field.is_array() || static_cast<int>(field.size()) != count)
+    {
+      error = name + " must be an array of " + std::to_string(count) +
+              " integers";
+      return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+      const json& element = field[static_cast<size_t>(i)];
+      if (!element.is_number_integer())
+      {
+        error = name + " must only hold integers";
+        return false;
+      }
+      values[i] = element.get<int>();
+    }
+    return true;
+  }
+
+  bool readIntArray(const json& object,
+                    const char* key,
+                    int* values,
+                    int count,
+                    std::string& error)
+  {
+    auto field = object.find(key);
+    return field == object.end() ||
+           readInts(*field, key, values, count, error);
+  }
+
+  bool readRange(const json& object,
+                 const char* key,
+                 TuningRange& range,
+                 std::string& error)
+  {
+    int bounds[2] = { range.min, range.max };
+    if (!readIntArray(object, key, bounds, 2, error))
+    {
+      return false;
+    }
+    range = { bounds[0], bounds[1] };
+    return true;
+  }
+
+  bool checkRange(const TuningRange& range,
+                  int limit,
+                  const char* name,
+                  std::string& error)
+  {
+    if (range.min <= 0 || range.max <= range.min || range.max > limit)
+    {
+      error = std::string(name) + " must satisfy 0 < min < max <= " +
+              std::to_string(limit);
+      return false;
+    }
+    return true;
+  }
+}
+
+/**
+ *   @brief   Reads the parameters from a JSON tuning file
+ *   @details Fields left out keep their current value. Parsing stops
+ *            at the first error, leaving the Tuning partly updated, so
+ *            callers parse into a copy.
+ *   @param   in The file contents.
+ *   @param   error Set to a description of the problem on failure.
+ *   @return  true if the whole file was read.
+ */
+
+bool Tuning::parse(std::istream& in, std::string& error)
+{
+  json root;
+  try
+  {
+    root = json::parse(in);
+  }
+  catch (const json::exception& e)
+  {
+    error = e.what();
+    return false;
+  }
+  if (!root.is_object())
+  {
+    error = "the tuning file must hold a JSON object";
+    return false;
+  }
+
+  static const json EMPTY = json::object();
+  auto sizes = root.find("sizes");
+  auto speeds = root.find("speeds");
+  const json& size_object = sizes != root.end() ? *sizes : EMPTY;
+  const json& speed_object = speeds != root.end() ? *speeds : EMPTY;
+  if (!size_object.is_object() || !speed_object.is_object())
+  {
+    error = "sizes and speeds must be objects";
+    return false;
+  }
+
+  bool read =
+    readRange(size_object, "standard", standard_size, error) &&
+    readRange(size_object, "small", small_size, error) &&
+    readRange(size_object, "tiny", tiny_size, error) &&
+    readRange(speed_object, "standard", standard_speed, error) &&
+    readRange(speed_object, "fast", fast_speed, error) &&
+    readRange(speed_object, "faster", faster_speed, error) &&
+    readInt(root, "special_power_gain", special_power_gain, error) &&
+    readInt(root, "life_loss", life_loss, error) &&
+    readInt(root, "stay_bonus", stay_bonus, error) &&
+    readIntArray(root,
+                 "difficulty_gates",
+                 difficulty_gates,
+                 DIFFICULTY_BRACKET_COUNT,
+                 error);
+  if (!read)
+  {
+    return false;
+  }
+
+  auto weights = root.find("spawn_weights");
+  if (weights == root.end())
+  {
+    return true;
+  }
+  if (!weights->is_array() ||
+      static_cast<int>(weights->size()) != SPAWN_ROW_COUNT)
+  {
+    error = "spawn_weights must hold " + std::to_string(SPAWN_ROW_COUNT) +
+            " rows, one per difficulty bracket";
+    return false;
+  }
+  for (int row = 0; row < SPAWN_ROW_COUNT; row++)
+  {
+    if (!readInts((*weights)[static_cast<size_t>(row)],
+                  "spawn_weights row " + std::to_string(row),
+                  spawn_weights[row],
+                  FISH_TYPE_COUNT,
+                  error))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ *   @brief   Checks the parameters can be played with
+ *   @details Ranges are rolled with a modulo of max - min, and a fish
+ *            has to fit in the window to be placed.
+ *   @param   error Set to a description of the problem on failure.
+ *   @return  true if every parameter is usable.
+ */
+
+bool Tuning::validate(std::string& error) const
+{
+  if (!checkRange(
+        standard_size, MAX_TUNED_FISH_SIZE, "sizes.standard", error) ||
+      !checkRange(small_size, MAX_TUNED_FISH_SIZE, "sizes.small", error) ||
+      !checkRange(tiny_size, MAX_TUNED_FISH_SIZE, "sizes.tiny", error) ||
+      !checkRange(standard_speed, MAX_TUNED_SPEED, "speeds.standard", error) ||
+      !checkRange(fast_speed, MAX_TUNED_SPEED, "speeds.fast", error) ||
+      !checkRange(faster_speed, MAX_TUNED_SPEED, "speeds.faster", error))
+  {
+    return false;
+  }
+  if (special_power_gain <= 0)
+  {
+    error = "special_power_gain must be positive";
+    return false;
+  }
+  if (life_loss < 0 || stay_bonus < 0)
+  {
+    error = "life_loss and stay_bonus can not be negative";
+    return false;
+  }
+  for (int i = 0; i < DIFFICULTY_BRACKET_COUNT; i++)
+  {
+    if (difficulty_gates[i] <= (i > 0 ? difficulty_gates[i - 1] : 0))
+    {
+      error = "difficulty_gates must be positive and increasing";
+      return false;
+    }
+  }
+  for (int row = 0; row < SPAWN_ROW_COUNT; row++)
+  {
+    int total = 0;
+    for (int type = 0; type < FISH_TYPE_COUNT; type++)
+    {
+      if (spawn_weights[row][type] < 0)
+      {
+        error = "spawn_weights can not be negative";
+        return false;
+      }
+      total += spawn_weights[row][type];
+    }
+    if (total <= 0)
+    {
+      error = "spawn_weights row " + std::to_string(row) + " is empty";
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ *   @brief   Builds the derived tables for a validated Tuning
+ *   @param   params Parameters that have passed validate().
+ *   @param   revision Counts the sets built, for reporting.
+ */
+
+std::shared_ptr<const TuningSet> TuningSet::build(const Tuning& params,
+                                                  int revision)
+{
+  auto set = std::make_shared<TuningSet>();
+  set->params = params;
+  set->revision = revision;
+  for (int row = 0; row < SPAWN_ROW_COUNT; row++)
+  {
+    for (int lost = 0; lost <= FISH_TYPE_COUNT; lost++)
+    {
+      int total = 0;
+      for (int type = 0; type < FISH_TYPE_COUNT; type++)
+      {
+        total += params.spawn_weights[row][type];
+        if (type == lost)
+        {
+          total += params.stay_bonus;
+        }
+        set->cumulative[row][lost][type] = total;
+      }
+    }
+  }
+  return set;
+}
+
+/**
+ *   @brief   The number a spawn roll is drawn from
+ *   @param   bracket The current difficulty bracket.
+ *   @param   type_lost The type given the stay bonus, or -1 for none.
+ */
+
+int TuningSet::spawnRange(int bracket, int type_lost) const
+{
+  int row = bracket < SPAWN_ROW_COUNT ? bracket : SPAWN_ROW_COUNT - 1;
+  int column = type_lost < 0 ? FISH_TYPE_COUNT : type_lost;
+  return cumulative[row][column][FISH_TYPE_COUNT - 1];
+}
+
+/**
+ *   @brief   Maps a roll in [1, spawnRange] to a fish type
+ */
+
+int TuningSet::spawnType(int bracket, int type_lost, int roll) const
+{
+  int row = bracket < SPAWN_ROW_COUNT ? bracket : SPAWN_ROW_COUNT - 1;
+  int column = type_lost < 0 ? FISH_TYPE_COUNT : type_lost;
+  for (int type = 0; type < FISH_TYPE_COUNT; type++)
+  {
+    if (roll <= cumulative[row][column][type])
+    {
+      return type;
+    }
+  }
+  return -1;
+}
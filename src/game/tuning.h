@@ -0,0 +1,81 @@
+#pragma once
+#include <istream>
+#include <memory>
+#include <string>
+
+enum
+{
+  FISH_TYPE_COUNT = 8,
+  DIFFICULTY_BRACKET_COUNT = 10,
+  SPAWN_ROW_COUNT = DIFFICULTY_BRACKET_COUNT + 1,
+  MAX_TUNED_FISH_SIZE = 256,
+  MAX_TUNED_SPEED = 5000
+};
+
+/**
+ *  An inclusive lower, exclusive upper bound a value is rolled in.
+ */
+struct TuningRange
+{
+  int min;
+  int max;
+};
+
+/**
+ *  Every gameplay parameter that can be changed without a rebuild.
+ *  The member initialisers are the built in values, used for anything
+ *  the tuning file leaves out.
+ */
+struct Tuning
+{
+  TuningRange standard_size = { 50, 64 };
+  TuningRange small_size = { 40, 48 };
+  TuningRange tiny_size = { 32, 38 };
+  TuningRange standard_speed = { 100, 200 };
+  TuningRange fast_speed = { 250, 400 };
+  TuningRange faster_speed = { 600, 800 };
+  int special_power_gain = 200; /**< Ability charge per second. */
+  int life_loss = 10;           /**< Arcade life drained per second. */
+  int stay_bonus = 25; /**< Extra weight for respawning a caught type. */
+  int difficulty_gates[DIFFICULTY_BRACKET_COUNT] = {
+    3, 10, 25, 60, 100, 200, 350, 500, 750, 1000
+  };
+  /** Spawn weights per fish type, one row per difficulty bracket. */
+  int spawn_weights[SPAWN_ROW_COUNT][FISH_TYPE_COUNT] = {
+    { 75, 0, 0, 0, 0, 0, 0, 0 },   { 50, 25, 0, 0, 0, 0, 0, 0 },
+    { 20, 45, 10, 0, 0, 0, 0, 0 }, { 0, 30, 30, 15, 0, 0, 0, 0 },
+    { 0, 0, 10, 35, 20, 10, 0, 0 }, { 0, 0, 0, 20, 10, 35, 10, 0 },
+    { 0, 0, 0, 20, 10, 20, 25, 0 }, { 0, 0, 0, 20, 0, 25, 25, 5 },
+    { 0, 0, 0, 20, 0, 20, 20, 15 }, { 0, 0, 0, 10, 0, 5, 10, 50 },
+    { 0, 0, 0, 0, 0, 0, 0, 75 }
+  };
+
+  bool parse(std::istream& in, std::string& error);
+  bool validate(std::string& error) const;
+};
+
+/**
+ *  A validated Tuning and the tables derived from it. Sets are built
+ *  once, never modified and shared, so one can be swapped in while the
+ *  previous is still being read.
+ */
+class TuningSet
+{
+ public:
+  static std::shared_ptr<const TuningSet> build(const Tuning& params,
+                                                int revision);
+
+  int spawnRange(int bracket, int type_lost) const;
+  int spawnType(int bracket, int type_lost, int roll) const;
+
+  Tuning params;
+  int revision = 0;
+
+ private:
+  /**
+   *  Running totals of the spawn weights for every bracket, with the
+   *  stay bonus added to each type in turn. The last column is for a
+   *  spawn without a bonus.
+   */
+  int cumulative[SPAWN_ROW_COUNT][FISH_TYPE_COUNT + 1][FISH_TYPE_COUNT] = {};
+};
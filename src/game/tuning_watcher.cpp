@@ -0,0 +1,206 @@
+#include <chrono>
+#include <fstream>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#  include <poll.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+#include "trace_recorder.h"
+#include "tuning_watcher.h"
+
+TuningWatcher::~TuningWatcher()
+{
+  stop();
+}
+
+/**
+ *   @brief   Loads the tuning file and starts watching it
+ *   @details The first load happens on the calling thread, so the game
+ *            starts with the file applied. A missing or invalid file
+ *            leaves the built in values in use. Its status is picked up
+ *            by the first poll().
+ *   @param   file_path The tuning file, relative to the working directory.
+ *   @return  The set to start the game with.
+ */
+
+std::shared_ptr<const TuningSet> TuningWatcher::start(
+  const std::string& file_path)
+{
+  stop();
+  path = file_path;
+  auto split = path.find_last_of("/\\");
+  directory = split == std::string::npos ? "." : path.substr(0, split);
+  file_name = split == std::string::npos ? path : path.substr(split + 1);
+
+  published = TuningSet::build(Tuning(), revision);
+  reload();
+
+  stopping = false;
+  watcher = std::thread(&TuningWatcher::watchLoop, this);
+
+  std::lock_guard<std::mutex> lock(published_mutex);
+  return published;
+}
+
+void TuningWatcher::stop()
+{
+  stopping = true;
+  if (watcher.joinable())
+  {
+    watcher.join();
+  }
+}
+
+/**
+ *   @brief   Picks up the result of the latest reload
+ *   @details Costs one atomic load when nothing changed, so it is safe
+ *            to call every frame.
+ *   @param   current Replaced by the new set when one was loaded.
+ *   @param   status Replaced by a line describing the reload.
+ *   @return  true if a reload finished since the last poll.
+ */
+
+bool TuningWatcher::poll(std::shared_ptr<const TuningSet>& current,
+                         std::string& status)
+{
+  if (!updated.load(std::memory_order_acquire))
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(published_mutex);
+  updated = false;
+  current = published;
+  status = published_status;
+  return true;
+}
+
+/**
+ *   @brief   Reads, validates and builds a new set from the file
+ *   @details Only a fully valid file replaces the published set,
+ *            otherwise the previous one stays and the error is kept
+ *            as the status.
+ */
+
+void TuningWatcher::reload()
+{
+  TRACE_SCOPE("reloadTuning", "tuning");
+  std::ifstream file(path);
+  Tuning params;
+  std::string error;
+  std::shared_ptr<const TuningSet> built;
+  if (!file)
+  {
+    error = "can not open " + path;
+  }
+  else if (params.parse(file, error) && params.validate(error))
+  {
+    built = TuningSet::build(params, ++revision);
+  }
+
+  std::lock_guard<std::mutex> lock(published_mutex);
+  if (built)
+  {
+    published = built;
+    published_status =
+      "Tuning r" + std::to_string(revision) + " loaded from " + path;
+  }
+  else
+  {
+    published_status = "Tuning r" + std::to_string(published->revision) +
+                       " kept, " + error;
+  }
+  updated.store(true, std::memory_order_release);
+}
+
+void TuningWatcher::watchLoop()
+{
+  TraceRecorder::nameThread("tuning watcher");
+  if (!watchWithInotify())
+  {
+    watchModifiedTime();
+  }
+}
+
+/**
+ *   @brief   Waits for the file to be written or replaced
+ *   @details Watches the directory rather than the file, as editors
+ *            often save by renaming a new file over the old one. After
+ *            an event it waits SETTLE_MS for the writes to finish.
+ *   @return  false if inotify is not available here.
+ */
+
+bool TuningWatcher::watchWithInotify()
+{
+#ifdef __linux__
+  int notifier = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (notifier < 0)
+  {
+    return false;
+  }
+  if (inotify_add_watch(
+        notifier, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+  {
+    close(notifier);
+    return false;
+  }
+
+  alignas(inotify_event) char events[4096];
+  while (!stopping)
+  {
+    pollfd waiting = { notifier, POLLIN, 0 };
+    if (::poll(&waiting, 1, WAKE_INTERVAL_MS) <= 0)
+    {
+      continue;
+    }
+    bool touched = false;
+    ssize_t length = 0;
+    while ((length = read(notifier, events, sizeof(events))) > 0)
+    {
+      for (ssize_t offset = 0; offset < length;)
+      {
+        const auto* event =
+          reinterpret_cast<const inotify_event*>(events + offset);
+        touched = touched || (event->len > 0 && file_name == event->name);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      }
+    }
+    if (touched)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS));
+      while (read(notifier, events, sizeof(events)) > 0)
+      {
+      }
+      reload();
+    }
+  }
+  close(notifier);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ *   @brief   Polls the modification time of the file
+ *   @details The fallback where inotify is not available.
+ */
+
+void TuningWatcher::watchModifiedTime()
+{
+  struct stat info;
+  auto modified = stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+  while (!stopping)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(WAKE_INTERVAL_MS));
+    auto now = stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+    if (now != modified)
+    {
+      modified = now;
+      std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS));
+      reload();
+    }
+  }
+}
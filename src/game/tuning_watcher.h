@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "tuning.h"
+
+/**
+ *  Keeps the game's TuningSet in step with a tuning file on disk.
+ *  A background thread waits for the file to change (inotify on Linux,
+ *  modification time polling elsewhere), then parses, validates and
+ *  builds the new set off the game thread. The game picks it up with
+ *  poll() between frames. A file that fails to parse or validate is
+ *  reported and the last good set stays in use.
+ */
+class TuningWatcher
+{
+ public:
+  enum
+  {
+    WAKE_INTERVAL_MS = 100,
+    SETTLE_MS = 50
+  };
+
+  TuningWatcher() = default;
+  ~TuningWatcher();
+  TuningWatcher(const TuningWatcher&) = delete;
+  TuningWatcher& operator=(const TuningWatcher&) = delete;
+
+  std::shared_ptr<const TuningSet> start(const std::string& file_path);
+  void stop();
+  bool poll(std::shared_ptr<const TuningSet>& current, std::string& status);
+
+ private:
+  void reload();
+  void watchLoop();
+  bool watchWithInotify();
+  void watchModifiedTime();
+
+  std::string path;
+  std::string directory;
+  std::string file_name;
+  int revision = 0; /**< Only touched by whichever thread is loading. */
+
+  std::mutex published_mutex;
+  std::shared_ptr<const TuningSet> published; /**< Last good set. */
+  std::string published_status;
+  std::atomic<bool> updated{ false };
+  std::atomic<bool> stopping{ false };
+  std::thread watcher;
+};
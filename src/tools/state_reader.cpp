@@ -0,0 +1,246 @@
+/**
+ *  Attaches to the live state a running game exports and shows it.
+ *
+ *  usage: StateReader [--name /nemo-live] [--interval ms] [--fish]
+ *                     [--record file.csv]
+ *
+ *  The shared memory object is mapped read only and read in place, a
+ *  sample is formatted straight from the mapping and thrown away if
+ *  the game wrote the block meanwhile. Only frames the game has moved
+ *  past since the last sample are shown or recorded.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "state_export_format.h"
+
+enum
+{
+  DEFAULT_INTERVAL_MS = 100,
+  READ_ATTEMPTS = 16
+};
+
+/**
+ *   @brief   Maps the game's block read only
+ *   @return  nullptr if it does not exist or is not a block this
+ *            reader understands.
+ */
+
+const StateExportBlock* attach(const char* name)
+{
+  int descriptor = shm_open(name, O_RDONLY, 0);
+  if (descriptor < 0)
+  {
+    std::fprintf(stderr, "%s: no such shared memory object\n", name);
+    return nullptr;
+  }
+  struct stat info;
+  if (fstat(descriptor, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(StateExportBlock))
+  {
+    std::fprintf(stderr, "%s: too small for a state block\n", name);
+    close(descriptor);
+    return nullptr;
+  }
+  void* mapping = mmap(
+    nullptr, sizeof(StateExportBlock), PROT_READ, MAP_SHARED, descriptor, 0);
+  close(descriptor);
+  if (mapping == MAP_FAILED)
+  {
+    std::fprintf(stderr, "%s: failed to map\n", name);
+    return nullptr;
+  }
+
+  const auto* block = static_cast<const StateExportBlock*>(mapping);
+  if (std::memcmp(block->magic, STATE_EXPORT_MAGIC, sizeof(block->magic)) !=
+        0 ||
+      block->version != STATE_EXPORT_VERSION ||
+      block->block_size != sizeof(StateExportBlock))
+  {
+    std::fprintf(stderr, "%s: not a version %d state block\n", name,
+                 STATE_EXPORT_VERSION);
+    munmap(mapping, sizeof(StateExportBlock));
+    return nullptr;
+  }
+  return block;
+}
+
+/**
+ *   @brief   Formats one sample from the mapping
+ *   @details Appends to line, which the caller discards if the sample
+ *            turns out to be torn.
+ */
+
+void format(const StateExportBlock& block,
+            bool csv,
+            bool fish,
+            std::string& line)
+{
+  char text[192];
+  std::snprintf(text,
+                sizeof(text),
+                csv ? "%llu,%d,%.1f,%d,%d,%d,%d,%.2f,%.2f,%.2f"
+                    : "frame %llu  score %d  life %.1f  bracket %d  mode %d"
+                      "  menu %d  fish %d  frame %.2fms mean %.2fms "
+                      "worst %.2fms",
+                static_cast<unsigned long long>(block.frame),
+                block.score,
+                static_cast<double>(block.life),
+                block.difficulty_state,
+                block.game_mode,
+                block.in_menu,
+                block.fish_count,
+                static_cast<double>(block.frame_ms),
+                static_cast<double>(block.frame_ms_mean),
+                static_cast<double>(block.frame_ms_worst));
+  line += text;
+  int count = block.fish_count;
+  count = count < 0 ? 0 : (count > STATE_EXPORT_MAX_FISH ? 0 : count);
+  for (int i = 0; fish && i < count; i++)
+  {
+    const StateExportFish& entry = block.fish[i];
+    if (entry.visible == 0)
+    {
+      continue;
+    }
+    std::snprintf(text,
+                  sizeof(text),
+                  csv ? ",%d:%d:%d:%u" : "\n  type %d at %d, %d size %u",
+                  entry.type,
+                  entry.x,
+                  entry.y,
+                  static_cast<unsigned>(entry.size));
+    line += text;
+  }
+  line += '\n';
+}
+
+/**
+ *   @brief   Takes a consistent sample of the block
+ *   @return  false if the game kept writing through every attempt.
+ */
+
+bool sample(const StateExportBlock& block,
+            bool csv,
+            bool fish,
+            std::string& line,
+            std::uint64_t& frame)
+{
+  for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++)
+  {
+    std::uint32_t before = block.sequence.load(std::memory_order_acquire);
+    if ((before & 1) != 0)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    line.clear();
+    frame = block.frame;
+    format(block, csv, fish, line);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (block.sequence.load(std::memory_order_relaxed) == before)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char* argv[])
+{
+  const char* name = STATE_EXPORT_DEFAULT_NAME;
+  const char* record_path = nullptr;
+  int interval_ms = DEFAULT_INTERVAL_MS;
+  bool fish = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc)
+    {
+      name = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--interval") == 0 && i + 1 < argc)
+    {
+      interval_ms = std::atoi(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+    {
+      record_path = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--fish") == 0)
+    {
+      fish = true;
+    }
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--name /nemo-live] [--interval ms] [--fish] "
+                   "[--record file.csv]\n",
+                   argv[0]);
+      return 1;
+    }
+  }
+
+  const StateExportBlock* block = attach(name);
+  if (block == nullptr)
+  {
+    return 1;
+  }
+
+  std::FILE* out = stdout;
+  bool csv = false;
+  if (record_path != nullptr)
+  {
+    out = std::fopen(record_path, "w");
+    if (out == nullptr)
+    {
+      std::fprintf(stderr, "%s: cannot write\n", record_path);
+      return 1;
+    }
+    csv = true;
+    std::fprintf(out,
+                 "frame,score,life,bracket,mode,menu,fish,frame_ms,"
+                 "mean_ms,worst_ms%s\n",
+                 fish ? ",fish type:x:y:size..." : "");
+  }
+
+  std::string line;
+  std::uint64_t last_frame = 0;
+  long torn = 0;
+  while (block->alive.load(std::memory_order_acquire) != 0)
+  {
+    std::uint64_t frame = 0;
+    if (!sample(*block, csv, fish, line, frame))
+    {
+      torn++;
+    }
+    else if (frame != last_frame)
+    {
+      std::fputs(line.c_str(), out);
+      std::fflush(out);
+      last_frame = frame;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+  }
+
+  std::fprintf(stderr, "%s: the game has exited", name);
+  if (torn > 0)
+  {
+    std::fprintf(stderr, ", %ld samples skipped while it was writing", torn);
+  }
+  std::fprintf(stderr, "\n");
+  if (out != stdout)
+  {
+    std::fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,331 @@
+/**
+ *  Aggregates gameplay telemetry files written by the game.
+ *
+ *  usage: TelemetryAnalyzer <file or directory>...
+ *
+ *  Directories are searched recursively for .ntl files. Files are
+ *  memory mapped and decoded in place, spread over one worker per
+ *  hardware thread.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "telemetry_format.h"
+#include "tuning.h"
+
+// the last bracket counts everything past the last gate
+enum
+{
+  BRACKET_COUNT = DIFFICULTY_BRACKET_COUNT + 1,
+  MODE_COUNT = 3
+};
+
+/**
+ *  Totals over any number of sessions, merged across workers.
+ */
+struct Summary
+{
+  long files = 0;
+  long rejected = 0;
+  long sessions[MODE_COUNT] = { 0 };
+  long unfinished = 0;
+  double seconds = 0;
+  long clicks = 0;
+  long hits = 0;
+  long catches[FISH_TYPE_COUNT] = { 0 };
+  long catch_score[FISH_TYPE_COUNT] = { 0 };
+  long reached_bracket[BRACKET_COUNT] = { 0 };
+  long final_score = 0;
+  long best_score = 0;
+  long life_samples = 0;
+  double life_total = 0;
+  long frames = 0;
+  double frame_us = 0;
+  double worst_frame_ms = 0;
+
+  void merge(const Summary& other)
+  {
+    files += other.files;
+    rejected += other.rejected;
+    unfinished += other.unfinished;
+    seconds += other.seconds;
+    clicks += other.clicks;
+    hits += other.hits;
+    final_score += other.final_score;
+    best_score = std::max(best_score, other.best_score);
+    life_samples += other.life_samples;
+    life_total += other.life_total;
+    frames += other.frames;
+    frame_us += other.frame_us;
+    worst_frame_ms = std::max(worst_frame_ms, other.worst_frame_ms);
+    for (int i = 0; i < MODE_COUNT; i++)
+    {
+      sessions[i] += other.sessions[i];
+    }
+    for (int i = 0; i < FISH_TYPE_COUNT; i++)
+    {
+      catches[i] += other.catches[i];
+      catch_score[i] += other.catch_score[i];
+    }
+    for (int i = 0; i < BRACKET_COUNT; i++)
+    {
+      reached_bracket[i] += other.reached_bracket[i];
+    }
+  }
+};
+
+/**
+ *   @brief   Adds every record of one mapped file to the summary
+ *   @return  false if the file is not a telemetry file.
+ */
+
+bool analyse(const unsigned char* data, size_t length, Summary& summary)
+{
+  TelemetryHeader header;
+  if (length < TELEMETRY_HEADER_SIZE || !TelemetryHeader::decode(data, header))
+  {
+    return false;
+  }
+
+  size_t records = (length - TELEMETRY_HEADER_SIZE) / TELEMETRY_RECORD_SIZE;
+  const unsigned char* cursor = data + TELEMETRY_HEADER_SIZE;
+  int bracket = 0;
+  bool ended = false;
+  std::uint32_t last_time = 0;
+  for (size_t i = 0; i < records; i++, cursor += TELEMETRY_RECORD_SIZE)
+  {
+    TelemetryRecord record = TelemetryRecord::decode(cursor);
+    last_time = std::max(last_time, record.time_ms);
+    switch (record.kind)
+    {
+      case TELEMETRY_CLICK:
+        summary.clicks++;
+        summary.hits += record.detail > 0 ? 1 : 0;
+        break;
+      case TELEMETRY_CATCH:
+        if (record.detail < FISH_TYPE_COUNT)
+        {
+          summary.catches[record.detail]++;
+          summary.catch_score[record.detail] += record.value;
+        }
+        break;
+      case TELEMETRY_DIFFICULTY:
+        bracket = std::max(bracket, static_cast<int>(record.detail));
+        break;
+      case TELEMETRY_LIFE:
+        summary.life_samples++;
+        summary.life_total += record.value;
+        break;
+      case TELEMETRY_FRAMES:
+        summary.frames += record.count;
+        summary.frame_us += record.value;
+        summary.worst_frame_ms =
+          std::max(summary.worst_frame_ms, record.x / 10.0);
+        break;
+      case TELEMETRY_END:
+        ended = true;
+        summary.final_score += record.value;
+        summary.best_score = std::max(summary.best_score,
+                                      static_cast<long>(record.value));
+        break;
+      default:
+        break;
+    }
+  }
+
+  summary.files++;
+  summary.sessions[header.game_mode < MODE_COUNT ? header.game_mode : 0]++;
+  summary.unfinished += ended ? 0 : 1;
+  summary.reached_bracket[std::min(bracket, BRACKET_COUNT - 1)]++;
+  summary.seconds += last_time / 1000.0;
+  return true;
+}
+
+/**
+ *   @brief   Maps a file and analyses it
+ */
+
+void analyseFile(const std::string& path, Summary& summary)
+{
+  int descriptor = open(path.c_str(), O_RDONLY);
+  if (descriptor < 0)
+  {
+    summary.rejected++;
+    return;
+  }
+  struct stat info;
+  if (fstat(descriptor, &info) != 0 || info.st_size <= 0)
+  {
+    close(descriptor);
+    summary.rejected++;
+    return;
+  }
+  auto length = static_cast<size_t>(info.st_size);
+  void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  close(descriptor);
+  if (mapping == MAP_FAILED)
+  {
+    summary.rejected++;
+    return;
+  }
+  madvise(mapping, length, MADV_SEQUENTIAL);
+  if (!analyse(static_cast<const unsigned char*>(mapping), length, summary))
+  {
+    summary.rejected++;
+  }
+  munmap(mapping, length);
+}
+
+/**
+ *   @brief   Collects the telemetry files under a path
+ */
+
+void collect(const std::string& path, std::vector<std::string>& files)
+{
+  DIR* directory = opendir(path.c_str());
+  if (directory == nullptr)
+  {
+    files.push_back(path);
+    return;
+  }
+  while (const dirent* entry = readdir(directory))
+  {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..")
+    {
+      continue;
+    }
+    std::string child = path + "/" + name;
+    struct stat info;
+    if (stat(child.c_str(), &info) != 0)
+    {
+      continue;
+    }
+    if (S_ISDIR(info.st_mode))
+    {
+      collect(child, files);
+    }
+    else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".ntl") == 0)
+    {
+      files.push_back(child);
+    }
+  }
+  closedir(directory);
+}
+
+void report(const Summary& summary)
+{
+  static const char* const TYPE_NAMES[FISH_TYPE_COUNT] = {
+    "standard", "fast",     "angled",  "fast angled",
+    "faster",   "slippery", "turning", "ultimate"
+  };
+
+  long session_count = 0;
+  for (long sessions : summary.sessions)
+  {
+    session_count += sessions;
+  }
+  std::printf("files      %ld read, %ld rejected\n",
+              summary.files,
+              summary.rejected);
+  std::printf("sessions   %ld standard, %ld arcade, %ld endless, "
+              "%ld unfinished\n",
+              summary.sessions[0],
+              summary.sessions[1],
+              summary.sessions[2],
+              summary.unfinished);
+  std::printf("play time  %.1f hours\n", summary.seconds / 3600.0);
+  std::printf("clicks     %ld, %.1f%% hit\n",
+              summary.clicks,
+              summary.clicks > 0 ? 100.0 * static_cast<double>(summary.hits) /
+                                    static_cast<double>(summary.clicks)
+                                : 0);
+  std::printf("score      mean %.1f, best %ld\n",
+              session_count > 0
+                ? static_cast<double>(summary.final_score) /
+                    static_cast<double>(session_count)
+                : 0,
+              summary.best_score);
+  if (summary.life_samples > 0)
+  {
+    std::printf("life       mean %.0f\n",
+                summary.life_total / static_cast<double>(summary.life_samples));
+  }
+  if (summary.frames > 0)
+  {
+    std::printf("frames     %ld, mean %.2fms, worst %.1fms\n",
+                summary.frames,
+                summary.frame_us / static_cast<double>(summary.frames) / 1000.0,
+                summary.worst_frame_ms);
+  }
+  std::printf("catches\n");
+  for (int i = 0; i < FISH_TYPE_COUNT; i++)
+  {
+    std::printf("  %-12s %8ld  score %ld\n",
+                TYPE_NAMES[i],
+                summary.catches[i],
+                summary.catch_score[i]);
+  }
+  std::printf("highest difficulty bracket reached\n");
+  for (int i = 0; i < BRACKET_COUNT; i++)
+  {
+    // endless brackets past the table are counted in the last row
+    std::printf(i + 1 < BRACKET_COUNT ? "  %2d  %8ld\n" : "  %2d+ %8ld\n",
+                i,
+                summary.reached_bracket[i]);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "usage: %s <file or directory>...\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++)
+  {
+    collect(argv[i], files);
+  }
+
+  unsigned worker_count = std::max(1u, std::thread::hardware_concurrency());
+  worker_count = std::min(worker_count, static_cast<unsigned>(files.size()));
+  std::vector<Summary> partial(std::max(1u, worker_count));
+  std::vector<std::thread> workers;
+  std::atomic<size_t> next_file(0);
+  for (unsigned w = 0; w < worker_count; w++)
+  {
+    workers.emplace_back([&files, &next_file, &partial, w] {
+      for (size_t i = next_file++; i < files.size(); i = next_file++)
+      {
+        analyseFile(files[i], partial[w]);
+      }
+    });
+  }
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  Summary total;
+  for (const auto& summary : partial)
+  {
+    total.merge(summary);
+  }
+  report(total);
+  return total.files > 0 ? 0 : 1;
+}